@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "batch.h"
+#include "evaluator.h"
+#include "result_cache.h"
+#include "tokenizer.h"
+
+namespace {
+
+constexpr size_t MIN_CHUNK_BYTES = 1 << 20;
+constexpr size_t WRITE_BUFFER_BYTES = 1 << 22;
+
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("无法打开文件: " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("无法读取文件信息: " + path);
+        }
+        size_ = (size_t)st.st_size;
+        if (size_) {
+            void *p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("mmap 失败: " + path);
+            }
+            ::madvise(p, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char *>(p);
+        }
+        ::close(fd);
+    }
+    ~MappedFile() {
+        if (data_) ::munmap(const_cast<char *>(data_), size_);
+    }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    std::string_view view() const { return {data_, size_}; }
+
+private:
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+void write_all(int fd, const char *p, size_t n) {
+    while (n) {
+        ssize_t w = ::write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("写出结果失败");
+        }
+        p += w;
+        n -= (size_t)w;
+    }
+}
+
+std::vector<std::string_view> split_chunks(std::string_view text, size_t chunk_bytes) {
+    std::vector<std::string_view> chunks;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = std::min(text.size(), pos + chunk_bytes);
+        if (end < text.size()) {
+            size_t nl = text.find('\n', end);
+            end = nl == std::string_view::npos ? text.size() : nl + 1;
+        }
+        chunks.push_back(text.substr(pos, end - pos));
+        pos = end;
+    }
+    return chunks;
+}
+
+struct ChunkResult {
+    std::string out;
+    size_t lines = 0;
+    size_t errors = 0;
+    bool done = false;
+};
+
+template <typename T>
+void append_number(std::string &out, T v) {
+    char buf[32];
+    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, ptr);
+}
+
+void evaluate_chunk(std::string_view chunk, ChunkResult &res, std::vector<Token> &token_list, ResultCache *cache) {
+    res.out.reserve(chunk.size());
+    size_t pos = 0;
+    while (pos < chunk.size()) {
+        size_t nl = chunk.find('\n', pos);
+        size_t end = nl == std::string_view::npos ? chunk.size() : nl;
+        std::string_view line = chunk.substr(pos, end - pos);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        pos = end + 1;
+        ++res.lines;
+
+        auto r = cache ? cached_evaluate(*cache, line, token_list) : try_evaluate(line, token_list);
+        if (r) {
+            append_number(res.out, *r);
+        } else {
+            ++res.errors;
+            res.out += "[错误] 位置 ";
+            append_number(res.out, r.error().pos);
+            res.out += ": ";
+            res.out += error_message(r.error());
+        }
+        res.out += '\n';
+    }
+}
+
+} // namespace
+
+BatchStats run_batch(const std::string &path, int out_fd, unsigned threads, ResultCache *cache) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    if (!threads) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    MappedFile file(path);
+    std::string_view text = file.view();
+    size_t chunk_bytes = std::max(MIN_CHUNK_BYTES, text.size() / (threads * 16) + 1);
+    auto chunks = split_chunks(text, chunk_bytes);
+
+    // 工作线程最多领先写出线程 window 个块，限制在途结果的内存占用
+    const size_t window = threads * 4;
+    std::vector<ChunkResult> results(chunks.size());
+    std::mutex mtx;
+    std::condition_variable cv_done, cv_window;
+    std::atomic<size_t> next{0};
+    size_t written = 0;
+
+    auto worker = [&] {
+        std::vector<Token> token_list;
+        while (true) {
+            size_t i = next.fetch_add(1);
+            if (i >= chunks.size()) return;
+            {
+                std::unique_lock lock(mtx);
+                cv_window.wait(lock, [&] { return i < written + window; });
+            }
+            ChunkResult local;
+            evaluate_chunk(chunks[i], local, token_list, cache);
+            {
+                std::lock_guard lock(mtx);
+                results[i] = std::move(local);
+                results[i].done = true;
+            }
+            cv_done.notify_one();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t)
+        pool.emplace_back(worker);
+
+    BatchStats stats;
+    stats.chunks = chunks.size();
+    try {
+        std::string pending;
+        pending.reserve(WRITE_BUFFER_BYTES);
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            std::string out;
+            {
+                std::unique_lock lock(mtx);
+                cv_done.wait(lock, [&] { return results[i].done; });
+                out = std::move(results[i].out);
+                stats.lines += results[i].lines;
+                stats.errors += results[i].errors;
+                results[i] = ChunkResult();
+                written = i + 1;
+            }
+            cv_window.notify_all();
+            if (pending.size() + out.size() > WRITE_BUFFER_BYTES) {
+                write_all(out_fd, pending.data(), pending.size());
+                pending.clear();
+            }
+            if (out.size() >= WRITE_BUFFER_BYTES)
+                write_all(out_fd, out.data(), out.size());
+            else
+                pending += out;
+        }
+        write_all(out_fd, pending.data(), pending.size());
+    } catch (...) {
+        next = chunks.size();
+        {
+            std::lock_guard lock(mtx);
+            written = chunks.size();
+        }
+        cv_window.notify_all();
+        for (auto &t : pool)
+            t.join();
+        throw;
+    }
+
+    for (auto &t : pool)
+        t.join();
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    stats.seconds = std::chrono::duration<double>(t1 - t0).count();
+    return stats;
+}
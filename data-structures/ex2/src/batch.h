@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+class ResultCache;
+
+struct BatchStats {
+    size_t lines = 0;
+    size_t errors = 0;
+    size_t chunks = 0;
+    double seconds = 0.0;
+};
+
+// 逐行求值 path 中的表达式，结果按输入顺序写到 out_fd。
+// 文件以 mmap 映射，按换行切块后交给 threads 个工作线程（0 表示取硬件线程数）。
+// cache 非空时各线程共享该结果缓存。
+BatchStats run_batch(const std::string &path, int out_fd, unsigned threads = 0, ResultCache *cache = nullptr);
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "columnar.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COLUMNAR_X86 1
+#endif
+
+namespace {
+
+// 栈槽：要么指向一块 n 个 double 的数据（变量列或中间结果），要么是广播常量
+struct Slot {
+    const double *ptr;
+    double scalar;
+};
+
+template <OpCode OP>
+inline double scalar_op(double a, double b) {
+    if constexpr (OP == OP_ADD) return a + b;
+    if constexpr (OP == OP_SUB) return a - b;
+    if constexpr (OP == OP_MUL) return a * b;
+    return a / b;
+}
+
+template <OpCode OP>
+void tile_op_generic(const double *a, double as, const double *b, double bs, double *dst, unsigned char *err,
+                     size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        double x = a ? a[i] : as;
+        double y = b ? b[i] : bs;
+        if constexpr (OP == OP_DIV) err[i] |= (y == 0);
+        dst[i] = scalar_op<OP>(x, y);
+    }
+}
+
+#ifdef COLUMNAR_X86
+template <OpCode OP>
+__attribute__((target("avx2"))) inline __m256d vec_op(__m256d a, __m256d b) {
+    if constexpr (OP == OP_ADD) return _mm256_add_pd(a, b);
+    if constexpr (OP == OP_SUB) return _mm256_sub_pd(a, b);
+    if constexpr (OP == OP_MUL) return _mm256_mul_pd(a, b);
+    return _mm256_div_pd(a, b);
+}
+
+template <OpCode OP>
+__attribute__((target("avx2"))) void tile_op_avx2(const double *a, double as, const double *b, double bs,
+                                                  double *dst, unsigned char *err, size_t n) {
+    const __m256d va_s = _mm256_set1_pd(as);
+    const __m256d vb_s = _mm256_set1_pd(bs);
+    const __m256d zero = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = a ? _mm256_loadu_pd(a + i) : va_s;
+        __m256d y = b ? _mm256_loadu_pd(b + i) : vb_s;
+        if constexpr (OP == OP_DIV) {
+            int m = _mm256_movemask_pd(_mm256_cmp_pd(y, zero, _CMP_EQ_OQ));
+            if (m) {
+                err[i] |= m & 1;
+                err[i + 1] |= (m >> 1) & 1;
+                err[i + 2] |= (m >> 2) & 1;
+                err[i + 3] |= (m >> 3) & 1;
+            }
+        }
+        _mm256_storeu_pd(dst + i, vec_op<OP>(x, y));
+    }
+    tile_op_generic<OP>(a ? a + i : nullptr, as, b ? b + i : nullptr, bs, dst + i, err + i, n - i);
+}
+
+const bool HAS_AVX2 = __builtin_cpu_supports("avx2");
+#else
+const bool HAS_AVX2 = false;
+#endif
+
+template <OpCode OP>
+void tile_op(const double *a, double as, const double *b, double bs, double *dst, unsigned char *err, size_t n) {
+#ifdef COLUMNAR_X86
+    if (HAS_AVX2) return tile_op_avx2<OP>(a, as, b, bs, dst, err, n);
+#endif
+    tile_op_generic<OP>(a, as, b, bs, dst, err, n);
+}
+
+} // namespace
+
+bool columnar_uses_avx2() { return HAS_AVX2; }
+
+size_t evaluate_columns(const Program &prog, const double *const *columns, size_t rows, double *out,
+                        unsigned char *div_zero) {
+    std::vector<double> scratch((size_t)prog.max_stack * COLUMNAR_TILE);
+    std::vector<Slot> stack(prog.max_stack);
+    unsigned char err[COLUMNAR_TILE];
+    size_t errors = 0;
+
+    for (size_t base = 0; base < rows; base += COLUMNAR_TILE) {
+        size_t n = std::min(COLUMNAR_TILE, rows - base);
+        std::fill(err, err + n, 0);
+        int sp = 0;
+        for (const Instr &ins : prog.code) {
+            if (ins.code == OP_CONST) {
+                stack[sp++] = {nullptr, prog.constants[ins.index]};
+                continue;
+            }
+            if (ins.code == OP_VAR) {
+                stack[sp++] = {columns[ins.index] + base, 0.0};
+                continue;
+            }
+            Slot b = stack[--sp];
+            Slot a = stack[sp - 1];
+            if (!a.ptr && !b.ptr) {
+                // 两个常量直接折叠；除零仍需逐行标记
+                if (ins.code == OP_DIV && b.scalar == 0) std::fill(err, err + n, 1);
+                double v = ins.code == OP_ADD   ? a.scalar + b.scalar
+                           : ins.code == OP_SUB ? a.scalar - b.scalar
+                           : ins.code == OP_MUL ? a.scalar * b.scalar
+                                                : a.scalar / b.scalar;
+                stack[sp - 1] = {nullptr, v};
+                continue;
+            }
+            double *dst = scratch.data() + (size_t)(sp - 1) * COLUMNAR_TILE;
+            switch (ins.code) {
+            case OP_ADD:
+                tile_op<OP_ADD>(a.ptr, a.scalar, b.ptr, b.scalar, dst, err, n);
+                break;
+            case OP_SUB:
+                tile_op<OP_SUB>(a.ptr, a.scalar, b.ptr, b.scalar, dst, err, n);
+                break;
+            case OP_MUL:
+                tile_op<OP_MUL>(a.ptr, a.scalar, b.ptr, b.scalar, dst, err, n);
+                break;
+            default:
+                tile_op<OP_DIV>(a.ptr, a.scalar, b.ptr, b.scalar, dst, err, n);
+                break;
+            }
+            stack[sp - 1] = {dst, 0.0};
+        }
+
+        double *o = out + base;
+        if (stack[0].ptr)
+            std::copy(stack[0].ptr, stack[0].ptr + n, o);
+        else
+            std::fill(o, o + n, stack[0].scalar);
+        for (size_t i = 0; i < n; ++i) {
+            if (err[i]) {
+                o[i] = std::numeric_limits<double>::quiet_NaN();
+                ++errors;
+            }
+        }
+        if (div_zero) std::copy(err, err + n, div_zero + base);
+    }
+    return errors;
+}
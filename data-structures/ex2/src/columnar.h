@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+
+#include "program.h"
+
+constexpr size_t COLUMNAR_TILE = 1024;
+
+// 对 rows 行数据逐块（每块 COLUMNAR_TILE 行）求值同一个表达式。
+// columns[v] 为第 v 个变量（Program::variables 顺序）的列；结果写入 out。
+// div_zero 非空时逐行记录是否发生除零，发生除零的行结果为 NaN。返回除零的行数。
+size_t evaluate_columns(const Program &prog, const double *const *columns, size_t rows, double *out,
+                        unsigned char *div_zero = nullptr);
+
+bool columnar_uses_avx2();
@@ -0,0 +1,163 @@
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "dag.h"
+#include "errors.h"
+
+namespace {
+
+uint64_t double_bits(double v) {
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+double fold(DagKind kind, double a, double b) {
+    switch (kind) {
+    case DAG_ADD:
+        return a + b;
+    case DAG_SUB:
+        return a - b;
+    case DAG_MUL:
+        return a * b;
+    default:
+        return a / b;
+    }
+}
+
+// 2 的整数次幂（含负指数）的倒数可精确表示，x / c 与 x * (1 / c) 逐位相同
+bool exact_reciprocal(double c) {
+    if (!std::isnormal(c)) return false;
+    int exp;
+    double m = std::frexp(c, &exp);
+    return std::fabs(m) == 0.5 && std::isnormal(1.0 / c);
+}
+
+} // namespace
+
+size_t ExprDag::KeyHash::operator()(const Key &k) const {
+    uint64_t h = k.bits ^ (uint64_t(k.kind) << 56) ^ (uint64_t(k.lhs) << 28) ^ k.rhs;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (size_t)h;
+}
+
+uint32_t ExprDag::intern(const DagNode &node, const Key &key) {
+    if (optimize_) {
+        auto it = interned_.find(key);
+        if (it != interned_.end()) return it->second;
+    }
+    uint32_t id = (uint32_t)nodes_.size();
+    nodes_.push_back(node);
+    if (optimize_) interned_.emplace(key, id);
+    return id;
+}
+
+uint32_t ExprDag::make_const(double v) { return intern({DAG_CONST, 0, 0, v}, {DAG_CONST, 0, 0, double_bits(v)}); }
+
+uint32_t ExprDag::make_var(uint32_t index) { return intern({DAG_VAR, index, 0, 0.0}, {DAG_VAR, index, 0, 0}); }
+
+uint32_t ExprDag::make_binary(DagKind kind, uint32_t a, uint32_t b) {
+    if (optimize_) {
+        const DagNode &na = nodes_[a], &nb = nodes_[b];
+        bool ca = na.kind == DAG_CONST, cb = nb.kind == DAG_CONST;
+        // 常量折叠；常量除以零保留原结点，求值时照常报除零
+        if (ca && cb && !(kind == DAG_DIV && nb.value == 0)) return make_const(fold(kind, na.value, nb.value));
+        // 只做在 IEEE 754 下对所有输入（含 -0、Inf、NaN）都成立的化简
+        if (kind == DAG_MUL && cb && nb.value == 1.0) return a;
+        if (kind == DAG_MUL && ca && na.value == 1.0) return b;
+        if (kind == DAG_DIV && cb && nb.value == 1.0) return a;
+        if (kind == DAG_SUB && cb && double_bits(nb.value) == double_bits(0.0)) return a;
+        if (kind == DAG_ADD && cb && double_bits(nb.value) == double_bits(-0.0)) return a;
+        if (kind == DAG_ADD && ca && double_bits(na.value) == double_bits(-0.0)) return b;
+        if (kind == DAG_DIV && cb && exact_reciprocal(nb.value)) return make_binary(DAG_MUL, a, make_const(1.0 / nb.value));
+        // 加法与乘法满足交换律，规范化操作数顺序以便合并 a+b 与 b+a
+        if ((kind == DAG_ADD || kind == DAG_MUL) && a > b) std::swap(a, b);
+    }
+    return intern({kind, a, b, 0.0}, {kind, a, b, 0});
+}
+
+ExprDag ExprDag::build(const Program &prog, bool optimize) {
+    ExprDag dag;
+    dag.optimize_ = optimize;
+    std::vector<uint32_t> stack;
+    stack.reserve(prog.max_stack);
+    for (const Instr &ins : prog.code) {
+        switch (ins.code) {
+        case OP_CONST:
+            stack.push_back(dag.make_const(prog.constants[ins.index]));
+            break;
+        case OP_VAR:
+            stack.push_back(dag.make_var(ins.index));
+            break;
+        default: {
+            uint32_t b = stack.back();
+            stack.pop_back();
+            uint32_t a = stack.back();
+            DagKind kind = ins.code == OP_ADD ? DAG_ADD : ins.code == OP_SUB ? DAG_SUB : ins.code == OP_MUL ? DAG_MUL : DAG_DIV;
+            stack.back() = dag.make_binary(kind, a, b);
+        }
+        }
+    }
+    dag.root_ = stack.back();
+    dag.interned_.clear();
+    if (optimize) dag.prune();
+    dag.values_.resize(dag.nodes_.size());
+    return dag;
+}
+
+// 删去化简后不再可达的结点（例如 x * 1 中的常量 1），并保持拓扑序
+void ExprDag::prune() {
+    std::vector<char> live(nodes_.size(), 0);
+    live[root_] = 1;
+    for (size_t i = nodes_.size(); i-- > 0;) {
+        if (!live[i]) continue;
+        const DagNode &n = nodes_[i];
+        if (n.kind != DAG_CONST && n.kind != DAG_VAR) live[n.lhs] = live[n.rhs] = 1;
+    }
+    std::vector<uint32_t> remap(nodes_.size());
+    std::vector<DagNode> kept;
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        if (!live[i]) continue;
+        DagNode n = nodes_[i];
+        if (n.kind != DAG_CONST && n.kind != DAG_VAR) {
+            n.lhs = remap[n.lhs];
+            n.rhs = remap[n.rhs];
+        }
+        remap[i] = (uint32_t)kept.size();
+        kept.push_back(n);
+    }
+    root_ = remap[root_];
+    nodes_ = std::move(kept);
+}
+
+double ExprDag::evaluate(const double *vars) const {
+    double *v = values_.data();
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        const DagNode &n = nodes_[i];
+        switch (n.kind) {
+        case DAG_CONST:
+            v[i] = n.value;
+            break;
+        case DAG_VAR:
+            v[i] = vars[n.lhs];
+            break;
+        case DAG_ADD:
+            v[i] = v[n.lhs] + v[n.rhs];
+            break;
+        case DAG_SUB:
+            v[i] = v[n.lhs] - v[n.rhs];
+            break;
+        case DAG_MUL:
+            v[i] = v[n.lhs] * v[n.rhs];
+            break;
+        case DAG_DIV:
+            if (v[n.rhs] == 0) throw std::runtime_error(ERR_DIV_ZERO);
+            v[i] = v[n.lhs] / v[n.rhs];
+            break;
+        }
+    }
+    return v[root_];
+}
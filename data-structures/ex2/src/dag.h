@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "program.h"
+
+enum DagKind : unsigned char { DAG_CONST, DAG_VAR, DAG_ADD, DAG_SUB, DAG_MUL, DAG_DIV };
+
+struct DagNode {
+    DagKind kind;
+    uint32_t lhs; // DAG_VAR: 变量下标
+    uint32_t rhs;
+    double value; // DAG_CONST: 常量值
+};
+
+// 表达式 DAG。结点按创建顺序存放在连续数组中，子结点下标总是小于父结点，
+// 因此顺序扫描一次即可按拓扑序求值，每个公共子表达式只计算一次。
+class ExprDag {
+public:
+    // optimize 为 false 时不做折叠、消除与化简，结点数等于指令数，用于对比
+    static ExprDag build(const Program &prog, bool optimize = true);
+
+    size_t size() const { return nodes_.size(); }
+    const std::vector<DagNode> &nodes() const { return nodes_; }
+    uint32_t root() const { return root_; }
+
+    // 与 run_program 结果逐位一致，除零时同样抛出 ERR_DIV_ZERO。复用内部缓冲区，同一对象不可并发求值
+    double evaluate(const double *vars) const;
+
+private:
+    struct Key {
+        DagKind kind;
+        uint32_t lhs, rhs;
+        uint64_t bits;
+        bool operator==(const Key &o) const = default;
+    };
+    struct KeyHash {
+        size_t operator()(const Key &k) const;
+    };
+
+    uint32_t make_const(double v);
+    uint32_t make_var(uint32_t index);
+    uint32_t make_binary(DagKind kind, uint32_t a, uint32_t b);
+    uint32_t intern(const DagNode &node, const Key &key);
+    void prune();
+
+    std::vector<DagNode> nodes_;
+    std::unordered_map<Key, uint32_t, KeyHash> interned_;
+    bool optimize_ = true;
+    uint32_t root_ = 0;
+    mutable std::vector<double> values_;
+};
@@ -0,0 +1,24 @@
+#include "errors.h"
+
+std::string error_message(const EvalError &e) {
+    switch (e.code) {
+    case E_BAD_NUMBER:
+        return ERR_BAD_NUMBER;
+    case E_DIV_ZERO:
+        return ERR_DIV_ZERO;
+    case E_EXTRA_OPERAND:
+        return ERR_EXTRA_OPERAND;
+    case E_ILLEGAL_CHAR:
+        return ERR_ILLEGAL_CHAR + std::string(e.detail);
+    case E_MISSING_OPERAND:
+        return ERR_MISSING_OPERAND;
+    case E_MULTIPLE_DOT:
+        return ERR_MULTIPLE_DOT;
+    case E_PAREN_MISMATCH:
+        return ERR_PAREN_MISMATCH;
+    case E_UNBOUND_VAR:
+        return ERR_UNBOUND_VAR + std::string(e.detail);
+    default:
+        return ERR_UNKNOWN_OP;
+    }
+}
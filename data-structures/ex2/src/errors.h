@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <string_view>
+
+inline const std::string ERR_BAD_NUMBER = "非法数字";
+inline const std::string ERR_DIV_ZERO = "除零错误";
+inline const std::string ERR_EXTRA_OPERAND = "表达式多余操作数";
+inline const std::string ERR_ILLEGAL_CHAR = "非法字符: ";
+inline const std::string ERR_MISSING_OPERAND = "表达式缺少操作数";
+inline const std::string ERR_MULTIPLE_DOT = "数字内重复小数点";
+inline const std::string ERR_PAREN_MISMATCH = "括号不匹配";
+inline const std::string ERR_UNBOUND_VAR = "未定义变量: ";
+inline const std::string ERR_UNKNOWN_OP = "未知运算符";
+
+enum ErrorCode : unsigned char {
+    E_BAD_NUMBER,
+    E_DIV_ZERO,
+    E_EXTRA_OPERAND,
+    E_ILLEGAL_CHAR,
+    E_MISSING_OPERAND,
+    E_MULTIPLE_DOT,
+    E_PAREN_MISMATCH,
+    E_UNBOUND_VAR,
+    E_UNKNOWN_OP,
+};
+
+struct EvalError {
+    ErrorCode code;
+    uint32_t pos = 0;        // 出错位置在输入中的下标
+    std::string_view detail = {}; // 非法字符或变量名，指向输入字符串
+};
+
+template <typename T>
+using EvalResult = std::expected<T, EvalError>;
+
+// 与原先各 throw 处一致的错误信息
+std::string error_message(const EvalError &e);
@@ -0,0 +1,119 @@
+#include <stack>
+#include <stdexcept>
+#include <string>
+
+#include "errors.h"
+#include "evaluator.h"
+
+int get_precedence(char op) {
+    if (op == '+' || op == '-') return 1;
+    if (op == '*' || op == '/') return 2;
+    return 0;
+}
+
+EvalResult<double> try_apply_operator(double a, double b, char op, uint32_t pos) {
+    switch (op) {
+    case '+':
+        return a + b;
+    case '-':
+        return a - b;
+    case '*':
+        return a * b;
+    case '/':
+        if (b == 0) return std::unexpected(EvalError{E_DIV_ZERO, pos});
+        return a / b;
+    default:
+        return std::unexpected(EvalError{E_UNKNOWN_OP, pos});
+    }
+}
+
+double apply_operator(double a, double b, char op) {
+    auto r = try_apply_operator(a, b, op);
+    if (!r) throw std::runtime_error(error_message(r.error()));
+    return *r;
+}
+
+namespace {
+
+struct Value {
+    double v;
+    uint32_t pos;
+};
+
+struct Operator {
+    char op;
+    uint32_t pos;
+};
+
+using ValueStack = std::stack<Value, std::vector<Value>>;
+using OperatorStack = std::stack<Operator, std::vector<Operator>>;
+
+EvalResult<void> reduce(ValueStack &value_stack, OperatorStack &op_stack) {
+    Operator op = op_stack.top();
+    op_stack.pop();
+    if (value_stack.size() < 2) return std::unexpected(EvalError{E_MISSING_OPERAND, op.pos});
+    Value b = value_stack.top();
+    value_stack.pop();
+    Value &a = value_stack.top();
+    auto r = try_apply_operator(a.v, b.v, op.op, op.pos);
+    if (!r) return std::unexpected(r.error());
+    a.v = *r;
+    return {};
+}
+
+} // namespace
+
+EvalResult<double> try_evaluate_expression(const std::vector<Token> &token_list) {
+    ValueStack value_stack;
+    OperatorStack op_stack;
+    for (const Token &token : token_list) {
+        if (token.type == NUMBER) {
+            value_stack.push({token.value, token.pos});
+        } else if (token.type == VARIABLE) {
+            return std::unexpected(EvalError{E_UNBOUND_VAR, token.pos, token.name});
+        } else if (token.type == OPERATOR) {
+            while (!op_stack.empty() && get_precedence(op_stack.top().op) >= get_precedence(token.op)) {
+                auto r = reduce(value_stack, op_stack);
+                if (!r) return std::unexpected(r.error());
+            }
+            op_stack.push({token.op, token.pos});
+        } else if (token.type == PARENTHESIS) {
+            if (token.op == '(') {
+                op_stack.push({'(', token.pos});
+            } else if (token.op == ')') {
+                bool found_left = false;
+                while (!op_stack.empty()) {
+                    if (op_stack.top().op == '(') {
+                        op_stack.pop();
+                        found_left = true;
+                        break;
+                    }
+                    auto r = reduce(value_stack, op_stack);
+                    if (!r) return std::unexpected(r.error());
+                }
+                if (!found_left) return std::unexpected(EvalError{E_PAREN_MISMATCH, token.pos});
+            }
+        }
+    }
+    while (!op_stack.empty()) {
+        if (op_stack.top().op == '(' || op_stack.top().op == ')')
+            return std::unexpected(EvalError{E_PAREN_MISMATCH, op_stack.top().pos});
+        auto r = reduce(value_stack, op_stack);
+        if (!r) return std::unexpected(r.error());
+    }
+    if (value_stack.size() != 1)
+        return std::unexpected(EvalError{E_EXTRA_OPERAND, value_stack.empty() ? 0 : value_stack.top().pos});
+    return value_stack.top().v;
+}
+
+EvalResult<double> try_evaluate(std::string_view expr, std::vector<Token> &token_list) {
+    auto r = tokenize(expr, token_list);
+    if (!r) return std::unexpected(r.error());
+    return try_evaluate_expression(token_list);
+}
+
+double evaluate_expression(const std::vector<Token> &token_list) {
+    auto r = try_evaluate_expression(token_list);
+    if (!r) throw std::runtime_error(error_message(r.error()));
+    return *r;
+}
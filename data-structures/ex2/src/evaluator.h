@@ -0,0 +1,18 @@
+#pragma once
+
+#include <vector>
+
+#include "errors.h"
+#include "tokenizer.h"
+
+int get_precedence(char op);
+
+// 不抛异常的求值路径，出错时返回带位置的 EvalError
+EvalResult<double> try_apply_operator(double a, double b, char op, uint32_t pos = 0);
+EvalResult<double> try_evaluate_expression(const std::vector<Token> &token_list);
+// 分词并求值，token_list 为调用方复用的缓冲区
+EvalResult<double> try_evaluate(std::string_view expr, std::vector<Token> &token_list);
+
+// 旧接口：包装上面的函数，出错时抛出 std::runtime_error
+double apply_operator(double a, double b, char op);
+double evaluate_expression(const std::vector<Token> &token_list);
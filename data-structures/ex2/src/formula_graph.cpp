@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "errors.h"
+#include "formula_graph.h"
+#include "program.h"
+#include "tokenizer.h"
+
+namespace {
+
+const std::string ERR_CYCLE = "公式存在循环依赖: ";
+constexpr size_t PARALLEL_LEVEL_MIN = 512;
+constexpr size_t PARALLEL_GRAIN = 128;
+
+} // namespace
+
+FormulaGraph::FormulaGraph(unsigned threads) : pool_(threads) {}
+
+uint32_t FormulaGraph::cell_id(const std::string &name) {
+    auto it = ids_.find(name);
+    if (it != ids_.end()) return it->second;
+    uint32_t id = (uint32_t)cells_.size();
+    cells_.emplace_back();
+    cells_.back().name = name;
+    cells_.back().result.error = ERR_UNBOUND_VAR + name;
+    ids_.emplace(name, id);
+    return id;
+}
+
+void FormulaGraph::unlink(uint32_t id) {
+    for (uint32_t d : cells_[id].deps) {
+        auto &ds = cells_[d].dependents;
+        ds.erase(std::find(ds.begin(), ds.end(), id));
+    }
+    cells_[id].deps.clear();
+}
+
+// from 沿 dependents 方向能否到达 targets 中任一单元格（即 targets 是否依赖 from）
+bool FormulaGraph::reaches(uint32_t from, const std::vector<uint32_t> &targets) const {
+    std::vector<char> seen(cells_.size(), 0);
+    std::vector<uint32_t> stack{from};
+    seen[from] = 1;
+    while (!stack.empty()) {
+        uint32_t c = stack.back();
+        stack.pop_back();
+        if (std::find(targets.begin(), targets.end(), c) != targets.end()) return true;
+        for (uint32_t d : cells_[c].dependents)
+            if (!seen[d]) {
+                seen[d] = 1;
+                stack.push_back(d);
+            }
+    }
+    return false;
+}
+
+// 层级 = 1 + 依赖的最大层级；从 id 起向下游传播变化
+void FormulaGraph::update_levels(uint32_t id) {
+    std::vector<uint32_t> stack{id};
+    while (!stack.empty()) {
+        uint32_t c = stack.back();
+        stack.pop_back();
+        uint32_t lvl = 0;
+        for (uint32_t d : cells_[c].deps)
+            lvl = std::max(lvl, cells_[d].level + 1);
+        if (lvl == cells_[c].level && c != id) continue;
+        cells_[c].level = lvl;
+        for (uint32_t d : cells_[c].dependents)
+            stack.push_back(d);
+    }
+}
+
+void FormulaGraph::mark_dirty(uint32_t id) {
+    if (cells_[id].dirty) return;
+    cells_[id].dirty = true;
+    dirty_.push_back(id);
+}
+
+void FormulaGraph::set_input(const std::string &name, double value) {
+    uint32_t id = cell_id(name);
+    Cell &c = cells_[id];
+    if (c.is_formula) {
+        unlink(id);
+        c.dag.reset();
+        c.is_formula = false;
+        --formulas_;
+        update_levels(id);
+    }
+    c.result = {value, {}};
+    for (uint32_t d : c.dependents)
+        mark_dirty(d);
+}
+
+void FormulaGraph::define(const std::string &name, const std::string &expr) {
+    Program prog = compile_expression(tokenize_expression(expr));
+    uint32_t id = cell_id(name);
+    std::vector<uint32_t> deps;
+    for (const auto &v : prog.variables)
+        deps.push_back(cell_id(v));
+    if (reaches(id, deps)) throw std::runtime_error(ERR_CYCLE + name);
+
+    Cell &c = cells_[id];
+    if (c.is_formula)
+        unlink(id);
+    else
+        ++formulas_;
+    c.is_formula = true;
+    c.dag = std::make_unique<ExprDag>(ExprDag::build(prog));
+    c.deps = std::move(deps);
+    for (uint32_t d : c.deps)
+        cells_[d].dependents.push_back(id);
+    update_levels(id);
+    mark_dirty(id);
+}
+
+void FormulaGraph::evaluate_cell(uint32_t id, std::vector<double> &vars) {
+    Cell &c = cells_[id];
+    vars.resize(c.deps.size());
+    for (size_t i = 0; i < c.deps.size(); ++i) {
+        const CellValue &dv = cells_[c.deps[i]].result;
+        if (!dv.error.empty()) {
+            c.result = {0.0, dv.error};
+            return;
+        }
+        vars[i] = dv.value;
+    }
+    try {
+        c.result = {c.dag->evaluate(vars.data()), {}};
+    } catch (const std::exception &e) {
+        c.result = {0.0, e.what()};
+    }
+}
+
+// 按层级从低到高求值；同层公式互不依赖，较多时分给线程池
+size_t FormulaGraph::run_levels(std::vector<uint32_t> &cells) {
+    std::sort(cells.begin(), cells.end(),
+              [&](uint32_t a, uint32_t b) { return cells_[a].level < cells_[b].level; });
+    size_t begin = 0;
+    while (begin < cells.size()) {
+        uint32_t lvl = cells_[cells[begin]].level;
+        size_t end = begin;
+        while (end < cells.size() && cells_[cells[end]].level == lvl)
+            ++end;
+        const uint32_t *level_cells = cells.data() + begin;
+        size_t n = end - begin;
+        if (n >= PARALLEL_LEVEL_MIN) {
+            pool_.parallel_for(n, PARALLEL_GRAIN, [&](size_t b, size_t e) {
+                std::vector<double> vars;
+                for (size_t i = b; i < e; ++i)
+                    evaluate_cell(level_cells[i], vars);
+            });
+        } else {
+            std::vector<double> vars;
+            for (size_t i = 0; i < n; ++i)
+                evaluate_cell(level_cells[i], vars);
+        }
+        begin = end;
+    }
+    return cells.size();
+}
+
+size_t FormulaGraph::recompute() {
+    if (dirty_.empty()) return 0;
+    // 从脏公式出发收集全部下游
+    std::vector<uint32_t> work;
+    work.swap(dirty_);
+    for (size_t i = 0; i < work.size(); ++i)
+        for (uint32_t d : cells_[work[i]].dependents)
+            if (!cells_[d].dirty) {
+                cells_[d].dirty = true;
+                work.push_back(d);
+            }
+    std::erase_if(work, [&](uint32_t id) {
+        cells_[id].dirty = false;
+        return !cells_[id].is_formula;
+    });
+    return run_levels(work);
+}
+
+size_t FormulaGraph::recompute_all() {
+    std::vector<uint32_t> work;
+    for (uint32_t id = 0; id < cells_.size(); ++id) {
+        cells_[id].dirty = false;
+        if (cells_[id].is_formula) work.push_back(id);
+    }
+    dirty_.clear();
+    return run_levels(work);
+}
+
+FormulaGraph::CellValue FormulaGraph::get(const std::string &name) {
+    recompute();
+    auto it = ids_.find(name);
+    if (it == ids_.end()) return {0.0, ERR_UNBOUND_VAR + name};
+    return cells_[it->second].result;
+}
+
+double FormulaGraph::evaluate(const std::string &expr) {
+    recompute();
+    Program prog = compile_expression(tokenize_expression(expr));
+    std::vector<double> vars;
+    for (const auto &v : prog.variables) {
+        auto it = ids_.find(v);
+        if (it == ids_.end()) throw std::runtime_error(ERR_UNBOUND_VAR + v);
+        const CellValue &cv = cells_[it->second].result;
+        if (!cv.error.empty()) throw std::runtime_error(cv.error);
+        vars.push_back(cv.value);
+    }
+    return run_program(prog, vars.data());
+}
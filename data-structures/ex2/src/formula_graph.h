@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dag.h"
+#include "thread_pool.h"
+
+// 相互引用的具名公式。维护依赖图与拓扑层级，输入变化后只重算下游的脏公式，
+// 同一层级内互不依赖的脏公式并行计算。
+class FormulaGraph {
+public:
+    struct CellValue {
+        double value = 0.0;
+        std::string error; // 非空表示该单元格求值出错
+    };
+
+    explicit FormulaGraph(unsigned threads = 0);
+
+    // 设置输入单元格；若该名字原本是公式，则改为输入
+    void set_input(const std::string &name, double value);
+    // 定义或重定义公式。语法错误或形成循环依赖时抛出 std::runtime_error，原定义保持不变
+    void define(const std::string &name, const std::string &expr);
+
+    // 重算所有脏公式，返回实际求值的公式个数
+    size_t recompute();
+    // 忽略脏标记重算全部公式，用于对比
+    size_t recompute_all();
+
+    CellValue get(const std::string &name);
+    // 用当前单元格的值求一个临时表达式，不加入依赖图
+    double evaluate(const std::string &expr);
+
+    size_t size() const { return cells_.size(); }
+    size_t formula_count() const { return formulas_; }
+
+private:
+    struct Cell {
+        std::string name;
+        bool is_formula = false;
+        std::unique_ptr<ExprDag> dag;
+        std::vector<uint32_t> deps; // 按 Program::variables 顺序
+        std::vector<uint32_t> dependents;
+        uint32_t level = 0;
+        bool dirty = false;
+        CellValue result;
+    };
+
+    uint32_t cell_id(const std::string &name);
+    void unlink(uint32_t id);
+    bool reaches(uint32_t from, const std::vector<uint32_t> &targets) const;
+    void update_levels(uint32_t id);
+    void mark_dirty(uint32_t id);
+    void evaluate_cell(uint32_t id, std::vector<double> &vars);
+    size_t run_levels(std::vector<uint32_t> &cells);
+
+    std::vector<Cell> cells_;
+    std::unordered_map<std::string, uint32_t> ids_;
+    std::vector<uint32_t> dirty_;
+    size_t formulas_ = 0;
+    ThreadPool pool_;
+};
@@ -0,0 +1,186 @@
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "errors.h"
+#include "jit.h"
+
+#if defined(__x86_64__) && defined(__unix__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define JIT_X86_64 1
+#endif
+
+namespace {
+
+#ifdef JIT_X86_64
+
+// 栈深 k 的值放在 xmm(k-1)，xmm15 固定为 0.0 用于除零判断
+constexpr int MAX_JIT_STACK = 15;
+constexpr int ZERO_REG = 15;
+
+class Emitter {
+public:
+    std::vector<uint8_t> buf;
+    std::vector<size_t> error_jumps; // 需要回填到错误出口的 rel32 位置
+
+    void byte(uint8_t b) { buf.push_back(b); }
+    void bytes(std::initializer_list<uint8_t> bs) { buf.insert(buf.end(), bs); }
+    void imm32(uint32_t v) {
+        for (int i = 0; i < 4; ++i)
+            byte(uint8_t(v >> (8 * i)));
+    }
+    void imm64(uint64_t v) {
+        for (int i = 0; i < 8; ++i)
+            byte(uint8_t(v >> (8 * i)));
+    }
+
+    static uint8_t modrm(int mod, int reg, int rm) { return uint8_t((mod << 6) | ((reg & 7) << 3) | (rm & 7)); }
+    void rex(bool w, int reg, int rm) {
+        uint8_t r = 0x40 | (w ? 8 : 0) | (reg >= 8 ? 4 : 0) | (rm >= 8 ? 1 : 0);
+        if (r != 0x40) byte(r);
+    }
+
+    // movsd xmm, [rdi + disp32]
+    void load_var(int xmm, uint32_t index) {
+        byte(0xF2);
+        rex(false, xmm, 0);
+        bytes({0x0F, 0x10, modrm(2, xmm, 7)});
+        imm32(index * 8);
+    }
+    // mov rax, imm64; movq xmm, rax
+    void load_const(int xmm, double v) {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        bytes({0x48, 0xB8});
+        imm64(bits);
+        byte(0x66);
+        rex(true, xmm, 0);
+        bytes({0x0F, 0x6E, modrm(3, xmm, 0)});
+    }
+    // addsd/subsd/mulsd/divsd dst, src
+    void arith(uint8_t opc, int dst, int src) {
+        byte(0xF2);
+        rex(false, dst, src);
+        bytes({0x0F, opc, modrm(3, dst, src)});
+    }
+    // ucomisd xmm, xmm15; jp 跳过；je 错误出口（NaN 除数与原实现一样不算除零）
+    void check_zero(int xmm) {
+        byte(0x66);
+        rex(false, xmm, ZERO_REG);
+        bytes({0x0F, 0x2E, modrm(3, xmm, ZERO_REG)});
+        bytes({0x7A, 0x06, 0x0F, 0x84});
+        error_jumps.push_back(buf.size());
+        imm32(0);
+    }
+    void prologue() {
+        // xorpd xmm15, xmm15
+        byte(0x66);
+        rex(false, ZERO_REG, ZERO_REG);
+        bytes({0x0F, 0x57, modrm(3, ZERO_REG, ZERO_REG)});
+    }
+    void epilogue() {
+        // movsd [rsi], xmm0; xor eax, eax; ret
+        bytes({0xF2, 0x0F, 0x11, modrm(0, 0, 6)});
+        bytes({0x31, 0xC0, 0xC3});
+        size_t err = buf.size();
+        // mov eax, 1; ret
+        bytes({0xB8, 0x01, 0x00, 0x00, 0x00, 0xC3});
+        for (size_t at : error_jumps) {
+            uint32_t rel = uint32_t(err - (at + 4));
+            std::memcpy(&buf[at], &rel, 4);
+        }
+    }
+};
+
+bool emit_program(const Program &prog, Emitter &e) {
+    if (prog.max_stack > MAX_JIT_STACK) return false;
+    e.prologue();
+    int sp = 0;
+    for (const Instr &ins : prog.code) {
+        switch (ins.code) {
+        case OP_CONST:
+            e.load_const(sp++, prog.constants[ins.index]);
+            break;
+        case OP_VAR:
+            e.load_var(sp++, ins.index);
+            break;
+        case OP_ADD:
+            --sp;
+            e.arith(0x58, sp - 1, sp);
+            break;
+        case OP_SUB:
+            --sp;
+            e.arith(0x5C, sp - 1, sp);
+            break;
+        case OP_MUL:
+            --sp;
+            e.arith(0x59, sp - 1, sp);
+            break;
+        case OP_DIV:
+            --sp;
+            e.check_zero(sp);
+            e.arith(0x5E, sp - 1, sp);
+            break;
+        }
+    }
+    e.epilogue();
+    return true;
+}
+
+#endif
+
+} // namespace
+
+bool jit_supported() {
+#ifdef JIT_X86_64
+    return __builtin_cpu_supports("sse2");
+#else
+    return false;
+#endif
+}
+
+JitExpression::JitExpression(const Program &prog) : prog_(prog) {
+#ifdef JIT_X86_64
+    if (!jit_supported()) return;
+    Emitter e;
+    if (!emit_program(prog_, e)) return;
+
+    size_t page = (size_t)::sysconf(_SC_PAGESIZE);
+    size_t size = (e.buf.size() + page - 1) / page * page;
+    void *mem = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) return;
+    std::memcpy(mem, e.buf.data(), e.buf.size());
+    if (::mprotect(mem, size, PROT_READ | PROT_EXEC) != 0) {
+        ::munmap(mem, size);
+        return;
+    }
+    code_ = mem;
+    code_size_ = e.buf.size();
+    mapped_size_ = size;
+    fn_ = reinterpret_cast<Fn>(mem);
+#endif
+}
+
+JitExpression::~JitExpression() {
+#ifdef JIT_X86_64
+    if (code_) ::munmap(code_, mapped_size_);
+#endif
+}
+
+int JitExpression::call(const double *vars, double *out) const {
+    if (fn_) return fn_(vars, out);
+    try {
+        *out = run_program(prog_, vars);
+        return 0;
+    } catch (const std::runtime_error &) {
+        return 1;
+    }
+}
+
+double JitExpression::operator()(const double *vars) const {
+    double out;
+    if (call(vars, &out)) throw std::runtime_error(ERR_DIV_ZERO);
+    return out;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+#include "program.h"
+
+// 把 Program 编译为 x86-64 SSE2 机器码（不依赖外部 JIT 库）。
+// 不支持的平台、栈深超过可用寄存器或分配可执行页失败时，自动回退到 run_program。
+class JitExpression {
+public:
+    explicit JitExpression(const Program &prog);
+    ~JitExpression();
+
+    JitExpression(const JitExpression &) = delete;
+    JitExpression &operator=(const JitExpression &) = delete;
+
+    bool compiled() const { return fn_ != nullptr; }
+    size_t code_size() const { return code_size_; }
+
+    // 与 run_program 语义一致：除零时抛出 ERR_DIV_ZERO
+    double operator()(const double *vars) const;
+    // 不抛异常的调用：成功返回 0 并写入 *out，除零返回 1
+    int call(const double *vars, double *out) const;
+
+private:
+    using Fn = int (*)(const double *vars, double *out);
+
+    Program prog_;
+    void *code_ = nullptr;
+    size_t code_size_ = 0;
+    size_t mapped_size_ = 0;
+    Fn fn_ = nullptr;
+};
+
+bool jit_supported();
@@ -1,153 +1,56 @@
-#include <cctype>
+#include <algorithm>
 #include <iostream>
-#include <sstream>
-#include <stack>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <unistd.h>
 #include <vector>
 
-const std::string ERR_DIV_ZERO = "除零错误";
-const std::string ERR_EXTRA_OPERAND = "表达式多余操作数";
-const std::string ERR_ILLEGAL_CHAR = "非法字符: ";
-const std::string ERR_MISSING_OPERAND = "表达式缺少操作数";
-const std::string ERR_MULTIPLE_DOT = "数字内重复小数点";
-const std::string ERR_PAREN_MISMATCH = "括号不匹配";
-const std::string ERR_UNKNOWN_OP = "未知运算符";
+#include "batch.h"
+#include "formula_graph.h"
+#include "result_cache.h"
+#include "tokenizer.h"
 
-enum TokenType { NUMBER, OPERATOR, PARENTHESIS };
-
-struct Token {
-    TokenType type;
-    union {
-        double value;
-        char op;
-    };
-    Token(TokenType t, double v) : type(t), value(v) {}
-    Token(TokenType t, char o) : type(t), op(o) {}
-};
-
-std::vector<Token> tokenize_expression(const std::string &expr) {
-    std::vector<Token> token_list;
-    size_t i = 0;
-    while (i < expr.length()) {
-        if (std::isspace(expr[i])) {
-            ++i;
-            continue;
-        }
-        if (std::isdigit(expr[i]) || expr[i] == '.') {
-            size_t start = i;
-            bool dot = false;
-            while (i < expr.length() && (std::isdigit(expr[i]) || expr[i] == '.')) {
-                if (expr[i] == '.') {
-                    if (dot) throw std::runtime_error(ERR_MULTIPLE_DOT);
-                    dot = true;
-                }
-                ++i;
-            }
-            double val = std::stod(expr.substr(start, i - start));
-            token_list.push_back(Token(NUMBER, val));
-        } else if (std::string("+-*/").find(expr[i]) != std::string::npos) {
-            token_list.push_back(Token(OPERATOR, expr[i]));
-            ++i;
-        } else if (expr[i] == '(' || expr[i] == ')') {
-            token_list.push_back(Token(PARENTHESIS, expr[i]));
-            ++i;
-        } else {
-            throw std::runtime_error(ERR_ILLEGAL_CHAR + expr[i]);
-        }
-    }
-    return token_list;
+// 形如 "name = expr" 的输入定义具名公式，返回 true 表示已处理
+bool handle_definition(FormulaGraph &graph, const std::string &line) {
+    size_t eq = line.find('=');
+    if (eq == std::string::npos) return false;
+    auto lhs = tokenize_expression(line.substr(0, eq));
+    if (lhs.size() != 1 || lhs[0].type != VARIABLE) throw std::runtime_error("赋值左侧必须是公式名");
+    std::string name(lhs[0].name);
+    graph.define(name, line.substr(eq + 1));
+    size_t n = graph.recompute();
+    auto cell = graph.get(name);
+    if (cell.error.empty())
+        std::cout << " " << name << " = " << cell.value;
+    else
+        std::cout << "[错误] " << name << ": " << cell.error;
+    std::cout << "（重算 " << n << " 个公式）" << std::endl;
+    return true;
 }
 
-int get_precedence(char op) {
-    if (op == '+' || op == '-') return 1;
-    if (op == '*' || op == '/') return 2;
-    return 0;
-}
-
-double apply_operator(double a, double b, char op) {
-    switch (op) {
-    case '+':
-        return a + b;
-    case '-':
-        return a - b;
-    case '*':
-        return a * b;
-    case '/':
-        if (b == 0) throw std::runtime_error(ERR_DIV_ZERO);
-        return a / b;
-    default:
-        throw std::runtime_error(ERR_UNKNOWN_OP);
-    }
-}
-
-double evaluate_expression(const std::vector<Token> &token_list) {
-    std::stack<double> value_stack;
-    std::stack<char> op_stack;
-    for (size_t i = 0; i < token_list.size(); ++i) {
-        const Token &token = token_list[i];
-        if (token.type == NUMBER) {
-            value_stack.push(token.value);
-        } else if (token.type == OPERATOR) {
-            while (!op_stack.empty() && get_precedence(op_stack.top()) >= get_precedence(token.op)) {
-                if (value_stack.size() < 2) throw std::runtime_error(ERR_MISSING_OPERAND);
-                double b = value_stack.top();
-                value_stack.pop();
-                double a = value_stack.top();
-                value_stack.pop();
-                char op = op_stack.top();
-                op_stack.pop();
-                value_stack.push(apply_operator(a, b, op));
-            }
-            op_stack.push(token.op);
-        } else if (token.type == PARENTHESIS) {
-            if (token.op == '(') {
-                op_stack.push('(');
-            } else if (token.op == ')') {
-                bool found_left = false;
-                while (!op_stack.empty()) {
-                    if (op_stack.top() == '(') {
-                        op_stack.pop();
-                        found_left = true;
-                        break;
-                    } else {
-                        if (value_stack.size() < 2) throw std::runtime_error(ERR_MISSING_OPERAND);
-                        double b = value_stack.top();
-                        value_stack.pop();
-                        double a = value_stack.top();
-                        value_stack.pop();
-                        char op = op_stack.top();
-                        op_stack.pop();
-                        value_stack.push(apply_operator(a, b, op));
-                    }
-                }
-                if (!found_left) throw std::runtime_error(ERR_PAREN_MISMATCH);
-            }
-        }
-    }
-    while (!op_stack.empty()) {
-        if (op_stack.top() == '(' || op_stack.top() == ')') throw std::runtime_error(ERR_PAREN_MISMATCH);
-        if (value_stack.size() < 2) throw std::runtime_error(ERR_MISSING_OPERAND);
-        double b = value_stack.top();
-        value_stack.pop();
-        double a = value_stack.top();
-        value_stack.pop();
-        char op = op_stack.top();
-        op_stack.pop();
-        value_stack.push(apply_operator(a, b, op));
-    }
-    if (value_stack.size() != 1) throw std::runtime_error(ERR_EXTRA_OPERAND);
-    return value_stack.top();
-}
-
-int main() {
+int run_repl() {
+    FormulaGraph graph;
+    ResultCache cache;
+    std::vector<Token> token_list;
     std::string input_line;
     do {
-        std::cout << "请输入中缀表达式（按 Ctrl+C 退出）：" << std::endl << ">> ";
+        std::cout << "请输入中缀表达式或 名称 = 表达式，:stats 查看缓存统计（按 Ctrl+C 退出）：" << std::endl << ">> ";
         std::getline(std::cin, input_line);
         try {
-            auto token_list = tokenize_expression(input_line);
-            double result = evaluate_expression(token_list);
+            if (input_line == ":stats") {
+                std::cout << format_cache_stats(cache.stats()) << std::endl;
+                continue;
+            }
+            if (handle_definition(graph, input_line)) continue;
+            auto r = cached_evaluate(cache, input_line, token_list);
+            double result;
+            if (r)
+                result = *r;
+            else if (r.error().code == E_UNBOUND_VAR)
+                result = graph.evaluate(input_line);
+            else
+                throw std::runtime_error(error_message(r.error()));
             std::cout << " = " << result << std::endl;
         } catch (const std::exception &e) {
             std::cout << "[错误] " << e.what() << std::endl;
@@ -155,3 +58,27 @@ int main() {
     } while (input_line.length());
     return 0;
 }
+
+int main(int argc, char **argv) {
+    if (argc >= 3 && std::string(argv[1]) == "--batch") {
+        unsigned threads = argc >= 4 ? (unsigned)std::stoul(argv[3]) : 0;
+        size_t cache_entries = argc >= 5 ? std::stoull(argv[4]) : 0;
+        try {
+            std::unique_ptr<ResultCache> cache;
+            if (cache_entries) cache = std::make_unique<ResultCache>(cache_entries);
+            BatchStats st = run_batch(argv[2], STDOUT_FILENO, threads, cache.get());
+            std::cerr << "lines: " << st.lines << ", errors: " << st.errors << ", chunks: " << st.chunks
+                      << ", time: " << st.seconds << "s, " << st.lines / st.seconds << " lines/s" << std::endl;
+            if (cache) std::cerr << format_cache_stats(cache->stats()) << std::endl;
+        } catch (const std::exception &e) {
+            std::cerr << "[错误] " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (argc > 1) {
+        std::cerr << "Usage: " << argv[0] << " [--batch FILE [THREADS [CACHE_ENTRIES]]]\n";
+        return 1;
+    }
+    return run_repl();
+}
@@ -0,0 +1,437 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "batch.h"
+#include "columnar.h"
+#include "dag.h"
+#include "evaluator.h"
+#include "formula_graph.h"
+#include "jit.h"
+#include "program.h"
+#include "result_cache.h"
+#include "tokenizer.h"
+
+std::string random_expression(std::mt19937 &rng, int terms) {
+    std::uniform_int_distribution<int> digit(0, 9), len(1, 6), op(0, 3), coin(0, 7);
+    const char ops[] = "+-*/";
+    std::string s;
+    int open = 0;
+    for (int t = 0; t < terms; ++t) {
+        if (t) {
+            s += ' ';
+            s += ops[op(rng)];
+            s += ' ';
+        }
+        if (coin(rng) == 0) {
+            s += '(';
+            ++open;
+        }
+        int n = len(rng);
+        for (int i = 0; i < n; ++i)
+            s += char('0' + digit(rng));
+        if (coin(rng) < 3) {
+            s += '.';
+            s += char('0' + digit(rng));
+        }
+        if (open && coin(rng) == 0) {
+            s += ')';
+            --open;
+        }
+    }
+    while (open--)
+        s += ')';
+    return s;
+}
+
+std::vector<std::string> make_corpus(size_t count, int terms, unsigned seed = 42) {
+    std::mt19937 rng(seed);
+    std::vector<std::string> corpus(count);
+    for (auto &e : corpus)
+        e = random_expression(rng, terms);
+    return corpus;
+}
+
+void profile_tokenize(std::ostream &out = std::cout) {
+    for (int terms : {2, 8, 32, 128}) {
+        auto corpus = make_corpus(2'000'000 / terms, terms);
+        size_t bytes = 0;
+        for (const auto &e : corpus)
+            bytes += e.size();
+
+        std::vector<Token> buf;
+        size_t tokens = 0;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (const auto &e : corpus) {
+            tokenize(e, buf);
+            tokens += buf.size();
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        double s = std::chrono::duration<double>(t1 - t0).count();
+        out << "terms=" << terms << " tokenize: " << s << "s, " << tokens / s << " tokens/s, " << bytes / s / 1e6
+            << " MB/s" << std::endl;
+
+        size_t tokens_legacy = 0;
+        t0 = std::chrono::high_resolution_clock::now();
+        for (const auto &e : corpus)
+            tokens_legacy += tokenize_expression(e).size();
+        t1 = std::chrono::high_resolution_clock::now();
+        s = std::chrono::duration<double>(t1 - t0).count();
+        out << "terms=" << terms << " tokenize_expression: " << s << "s, " << tokens_legacy / s << " tokens/s"
+            << std::endl;
+    }
+}
+
+void profile_batch(std::ostream &out = std::cout) {
+    const std::string path = "ex2_batch_input.txt";
+    {
+        std::mt19937 rng(42);
+        std::ofstream fout(path);
+        for (size_t i = 0; i < 2'000'000; ++i)
+            fout << random_expression(rng, 8) << '\n';
+    }
+    int null_fd = ::open("/dev/null", O_WRONLY);
+    unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned t = 1; t <= max_threads; t *= 2) {
+        BatchStats st = run_batch(path, null_fd, t);
+        out << "threads=" << t << " batch: " << st.seconds << "s, " << st.lines / st.seconds << " lines/s" << std::endl;
+    }
+    ::close(null_fd);
+    std::remove(path.c_str());
+}
+
+void profile_columnar(std::ostream &out = std::cout) {
+    const std::string formula = "(a + b) * c - d / (e + 1) + a * 0.5";
+    const size_t rows = 1'000'000;
+    auto tokens = tokenize_expression(formula);
+    Program prog = compile_expression(tokens);
+    size_t nvars = prog.variables.size();
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> dist(-100.0, 100.0);
+    std::vector<std::vector<double>> cols(nvars, std::vector<double>(rows));
+    for (auto &c : cols)
+        for (auto &x : c)
+            x = dist(rng);
+    for (size_t r = 0; r < rows; r += 1000)
+        cols[prog.variable_index("e")][r] = -1.0; // 部分行除零
+    std::vector<const double *> col_ptrs;
+    for (auto &c : cols)
+        col_ptrs.push_back(c.data());
+
+    // 标量路径：逐行把变量替换为数字后走 evaluate_expression
+    std::vector<double> ref(rows);
+    std::vector<Token> row_tokens = tokens;
+    size_t errs = 0;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t i = 0; i < tokens.size(); ++i)
+            if (tokens[i].type == VARIABLE)
+                row_tokens[i] = Token(NUMBER, cols[prog.variable_index(std::string(tokens[i].name))][r]);
+        try {
+            ref[r] = evaluate_expression(row_tokens);
+        } catch (const std::exception &) {
+            ++errs;
+        }
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    double s = std::chrono::duration<double>(t1 - t0).count();
+    out << "evaluate_expression: " << s << "s, " << rows / s << " rows/s, div0 rows=" << errs << std::endl;
+
+    std::vector<double> vars(nvars), res(rows);
+    errs = 0;
+    t0 = std::chrono::high_resolution_clock::now();
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t v = 0; v < nvars; ++v)
+            vars[v] = cols[v][r];
+        try {
+            res[r] = run_program(prog, vars.data());
+        } catch (const std::exception &) {
+            ++errs;
+        }
+    }
+    t1 = std::chrono::high_resolution_clock::now();
+    s = std::chrono::duration<double>(t1 - t0).count();
+    out << "run_program: " << s << "s, " << rows / s << " rows/s, div0 rows=" << errs << std::endl;
+
+    std::vector<unsigned char> div_zero(rows);
+    t0 = std::chrono::high_resolution_clock::now();
+    errs = evaluate_columns(prog, col_ptrs.data(), rows, res.data(), div_zero.data());
+    t1 = std::chrono::high_resolution_clock::now();
+    s = std::chrono::duration<double>(t1 - t0).count();
+    out << "evaluate_columns (" << (columnar_uses_avx2() ? "avx2" : "scalar") << "): " << s << "s, " << rows / s
+        << " rows/s, div0 rows=" << errs << std::endl;
+
+    size_t mismatches = 0;
+    for (size_t r = 0; r < rows; ++r)
+        if (!div_zero[r] && res[r] != ref[r]) ++mismatches;
+    out << "columnar mismatches vs evaluate_expression: " << mismatches << std::endl;
+}
+
+void profile_jit(std::ostream &out = std::cout) {
+    for (const std::string formula : {"a * b + c", "(a + b) * c - d / (e + 1) + a * 0.5",
+                                      "((a - b) * (a + b) / (c * c + 1) - d) * (e - 2.5) / (a * a + b * b + 1)"}) {
+        Program prog = compile_expression(tokenize_expression(formula));
+
+        const int compiles = 10'000;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < compiles; ++i)
+            JitExpression tmp(prog);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        double compile_us = std::chrono::duration<double, std::micro>(t1 - t0).count() / compiles;
+
+        JitExpression jit(prog);
+        std::vector<double> vars(prog.variables.size(), 1.5);
+        const size_t calls = 20'000'000;
+        double acc = 0;
+        t0 = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < calls; ++i) {
+            vars[0] = double(i & 1023);
+            double r;
+            if (!jit.call(vars.data(), &r)) acc += r;
+        }
+        t1 = std::chrono::high_resolution_clock::now();
+        double s_jit = std::chrono::duration<double>(t1 - t0).count();
+
+        t0 = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < calls; ++i) {
+            vars[0] = double(i & 1023);
+            try {
+                acc += run_program(prog, vars.data());
+            } catch (const std::exception &) {
+            }
+        }
+        t1 = std::chrono::high_resolution_clock::now();
+        double s_interp = std::chrono::duration<double>(t1 - t0).count();
+
+        out << formula << std::endl;
+        out << "  jit (" << (jit.compiled() ? "native" : "fallback") << ", " << jit.code_size()
+            << " bytes): compile " << compile_us << "us, " << calls / s_jit << " calls/s" << std::endl;
+        out << "  run_program: " << calls / s_interp << " calls/s (checksum " << acc << ")" << std::endl;
+    }
+}
+
+const std::vector<std::string> FORMULA_CORPUS = {
+    "m * 9.81 * h + 0.5 * m * v * v",
+    "w / (h / 100 * (h / 100))",
+    "(x - mu) * (x - mu) / (2 * s * s)",
+    "p * (1 + r / 12) * (1 + r / 12) * (1 + r / 12) * (1 + r / 12)",
+    "(price * qty - discount) * (1 + tax / 100)",
+    "(a + b) * (a + b) - (a - b) * (a - b)",
+    "(x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1) + (z2 - z1) * (z2 - z1)",
+    "(c * 9 / 5 + 32 - 32) * 5 / 9 * 1",
+    "(revenue - cost) / revenue * 100 - (revenue - cost) / cost * 100",
+    "v0 * t + 0.5 * 9.81 * t * t - v0 * t * (3 - 2)",
+};
+
+void profile_dag(std::ostream &out = std::cout) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> dist(1.0, 100.0);
+    const int evals = 2'000'000;
+    size_t total_before = 0, total_after = 0;
+    double total_plain = 0, total_opt = 0;
+    for (const auto &formula : FORMULA_CORPUS) {
+        Program prog = compile_expression(tokenize_expression(formula));
+        ExprDag plain = ExprDag::build(prog, false);
+        ExprDag opt = ExprDag::build(prog);
+        std::vector<double> vars(prog.variables.size());
+        for (auto &v : vars)
+            v = dist(rng);
+
+        double acc = 0;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < evals; ++i) {
+            vars[0] += 1e-9;
+            acc += plain.evaluate(vars.data());
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        double s_plain = std::chrono::duration<double>(t1 - t0).count();
+        t0 = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < evals; ++i) {
+            vars[0] += 1e-9;
+            acc += opt.evaluate(vars.data());
+        }
+        t1 = std::chrono::high_resolution_clock::now();
+        double s_opt = std::chrono::duration<double>(t1 - t0).count();
+
+        total_before += plain.size();
+        total_after += opt.size();
+        total_plain += s_plain;
+        total_opt += s_opt;
+        out << formula << std::endl;
+        out << "  nodes: " << plain.size() << " -> " << opt.size() << ", eval: " << s_plain / evals * 1e9 << "ns -> "
+            << s_opt / evals * 1e9 << "ns (checksum " << acc << ")" << std::endl;
+    }
+    out << "corpus nodes: " << total_before << " -> " << total_after << ", eval time: " << total_plain << "s -> "
+        << total_opt << "s" << std::endl;
+}
+
+void profile_formulas(std::ostream &out = std::cout) {
+    const size_t inputs = 1'000, formulas = 100'000, block = formulas / inputs;
+    std::mt19937 rng(42);
+    FormulaGraph graph;
+    std::vector<std::string> names;
+    for (size_t i = 0; i < inputs; ++i) {
+        names.push_back("in" + std::to_string(i));
+        graph.set_input(names.back(), double(i % 17 + 1));
+    }
+    // 类似电子表格：每个输入带一块 block 个公式，公式引用本块的输入和本块之前的公式
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (size_t f = 0; f < formulas; ++f) {
+        size_t b = f / block, first = inputs + b * block;
+        std::uniform_int_distribution<size_t> pick(first, inputs + f);
+        std::uniform_int_distribution<int> refs(1, 3), op(0, 2);
+        auto ref = [&] {
+            size_t r = pick(rng);
+            return r == inputs + f ? names[b] : names[r];
+        };
+        std::string expr = ref();
+        for (int r = refs(rng); r > 1; --r)
+            expr += std::string(" ") + "+-*"[op(rng)] + " " + ref() + " * 0.5";
+        names.push_back("f" + std::to_string(f));
+        graph.define(names.back(), expr);
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    out << "build " << formulas << " formulas: " << std::chrono::duration<double>(t1 - t0).count() << "s" << std::endl;
+
+    t0 = std::chrono::high_resolution_clock::now();
+    size_t n = graph.recompute();
+    t1 = std::chrono::high_resolution_clock::now();
+    out << "initial recompute: " << n << " formulas, " << std::chrono::duration<double>(t1 - t0).count() << "s"
+        << std::endl;
+
+    const int updates = 200;
+    double total = 0, worst = 0;
+    size_t evaluated = 0;
+    std::uniform_int_distribution<size_t> which(0, inputs - 1);
+    for (int u = 0; u < updates; ++u) {
+        auto u0 = std::chrono::high_resolution_clock::now();
+        graph.set_input(names[which(rng)], double(u));
+        evaluated += graph.recompute();
+        auto u1 = std::chrono::high_resolution_clock::now();
+        double s = std::chrono::duration<double>(u1 - u0).count();
+        total += s;
+        worst = std::max(worst, s);
+    }
+    out << "single-input update: avg " << total / updates * 1e6 << "us, max " << worst * 1e6 << "us, avg "
+        << evaluated / updates << " formulas re-evaluated" << std::endl;
+
+    t0 = std::chrono::high_resolution_clock::now();
+    n = graph.recompute_all();
+    t1 = std::chrono::high_resolution_clock::now();
+    out << "full recompute: " << n << " formulas, " << std::chrono::duration<double>(t1 - t0).count() * 1e6 << "us"
+        << std::endl;
+}
+
+void profile_errors(std::ostream &out = std::cout) {
+    const char *invalid[] = {"1 + 2 / (3 - 3)", "(1 + 2 * 3", "4 * $ 2", "1 + * 2", "1..5 + 2", "7 8 + 1"};
+    for (int percent : {0, 10, 50}) {
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> coin(0, 99), which(0, 5);
+        std::vector<std::string> corpus;
+        for (size_t i = 0; i < 500'000; ++i) {
+            if (coin(rng) < percent)
+                corpus.push_back(invalid[which(rng)]);
+            else
+                corpus.push_back("(" + std::to_string(i % 97 + 1) + " + 2.5) * 3 - 4 / 2");
+        }
+
+        size_t errs = 0;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (const auto &e : corpus) {
+            try {
+                evaluate_expression(tokenize_expression(e));
+            } catch (const std::exception &) {
+                ++errs;
+            }
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        double s_throw = std::chrono::duration<double>(t1 - t0).count();
+
+        size_t errs2 = 0;
+        std::vector<Token> buf;
+        t0 = std::chrono::high_resolution_clock::now();
+        for (const auto &e : corpus) {
+            auto r = try_evaluate(e, buf);
+            if (!r) ++errs2;
+        }
+        t1 = std::chrono::high_resolution_clock::now();
+        double s_expected = std::chrono::duration<double>(t1 - t0).count();
+
+        out << percent << "% invalid (" << errs << "/" << errs2 << " errors): exceptions " << corpus.size() / s_throw
+            << " lines/s, expected " << corpus.size() / s_expected << " lines/s" << std::endl;
+    }
+}
+
+void profile_cache(std::ostream &out = std::cout) {
+    // 1 万个不同表达式，按 Zipf 分布抽取，每次随机改变空白
+    const size_t distinct = 10'000, queries = 1'000'000;
+    std::mt19937 rng(42);
+    std::vector<std::string> exprs;
+    for (size_t i = 0; i < distinct; ++i)
+        exprs.push_back(random_expression(rng, 12));
+    std::vector<double> weights(distinct);
+    for (size_t i = 0; i < distinct; ++i)
+        weights[i] = 1.0 / double(i + 1);
+    std::discrete_distribution<size_t> zipf(weights.begin(), weights.end());
+    std::uniform_int_distribution<int> spaces(0, 2);
+    std::vector<std::string> workload;
+    for (size_t q = 0; q < queries; ++q) {
+        std::string s;
+        for (char c : exprs[zipf(rng)]) {
+            if (c == ' ')
+                s.append(spaces(rng), ' ');
+            else
+                s += c;
+        }
+        workload.push_back(std::move(s));
+    }
+
+    std::vector<Token> buf;
+    double sink = 0;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (size_t q = 0; q < queries; ++q)
+        if (auto r = try_evaluate(workload[q], buf)) sink += *r;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    out << "uncached: " << queries / std::chrono::duration<double>(t1 - t0).count() << " queries/s" << std::endl;
+
+    for (size_t capacity : {256, 2'048, 16'384}) {
+        ResultCache cache(capacity);
+        t0 = std::chrono::high_resolution_clock::now();
+        for (size_t q = 0; q < queries; ++q)
+            if (auto r = cached_evaluate(cache, workload[q], buf)) sink += *r;
+        t1 = std::chrono::high_resolution_clock::now();
+        out << "capacity=" << capacity << ": " << queries / std::chrono::duration<double>(t1 - t0).count()
+            << " queries/s, " << format_cache_stats(cache.stats()) << std::endl;
+    }
+    out << "checksum " << sink << std::endl;
+}
+
+int main(int argc, char **argv) {
+    std::string what = argc > 1 ? argv[1] : "all";
+    if (what == "tokenize" || what == "all")
+        profile_tokenize();
+    if (what == "batch" || what == "all")
+        profile_batch();
+    if (what == "columnar" || what == "all")
+        profile_columnar();
+    if (what == "jit" || what == "all")
+        profile_jit();
+    if (what == "dag" || what == "all")
+        profile_dag();
+    if (what == "formulas" || what == "all")
+        profile_formulas();
+    if (what == "errors" || what == "all")
+        profile_errors();
+    if (what == "cache" || what == "all")
+        profile_cache();
+    return 0;
+}
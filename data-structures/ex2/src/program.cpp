@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <stack>
+#include <stdexcept>
+
+#include "errors.h"
+#include "evaluator.h"
+#include "program.h"
+
+int Program::variable_index(const std::string &name) const {
+    auto it = std::find(variables.begin(), variables.end(), name);
+    return it == variables.end() ? -1 : int(it - variables.begin());
+}
+
+OpCode opcode_for(char op) {
+    switch (op) {
+    case '+':
+        return OP_ADD;
+    case '-':
+        return OP_SUB;
+    case '*':
+        return OP_MUL;
+    case '/':
+        return OP_DIV;
+    default:
+        throw std::runtime_error(ERR_UNKNOWN_OP);
+    }
+}
+
+namespace {
+
+struct Compiler {
+    Program prog;
+    std::stack<char> op_stack;
+    int depth = 0;
+
+    void push(Instr ins) {
+        prog.code.push_back(ins);
+        prog.max_stack = std::max(prog.max_stack, ++depth);
+    }
+
+    void reduce() {
+        if (depth < 2) throw std::runtime_error(ERR_MISSING_OPERAND);
+        char op = op_stack.top();
+        op_stack.pop();
+        prog.code.push_back({opcode_for(op), 0});
+        --depth;
+    }
+};
+
+} // namespace
+
+Program compile_expression(const std::vector<Token> &token_list) {
+    Compiler c;
+    for (const Token &token : token_list) {
+        if (token.type == NUMBER) {
+            c.push({OP_CONST, (uint32_t)c.prog.constants.size()});
+            c.prog.constants.push_back(token.value);
+        } else if (token.type == VARIABLE) {
+            std::string name(token.name);
+            int idx = c.prog.variable_index(name);
+            if (idx < 0) {
+                idx = (int)c.prog.variables.size();
+                c.prog.variables.push_back(name);
+            }
+            c.push({OP_VAR, (uint32_t)idx});
+        } else if (token.type == OPERATOR) {
+            while (!c.op_stack.empty() && get_precedence(c.op_stack.top()) >= get_precedence(token.op))
+                c.reduce();
+            c.op_stack.push(token.op);
+        } else if (token.type == PARENTHESIS) {
+            if (token.op == '(') {
+                c.op_stack.push('(');
+            } else {
+                bool found_left = false;
+                while (!c.op_stack.empty()) {
+                    if (c.op_stack.top() == '(') {
+                        c.op_stack.pop();
+                        found_left = true;
+                        break;
+                    }
+                    c.reduce();
+                }
+                if (!found_left) throw std::runtime_error(ERR_PAREN_MISMATCH);
+            }
+        }
+    }
+    while (!c.op_stack.empty()) {
+        if (c.op_stack.top() == '(' || c.op_stack.top() == ')') throw std::runtime_error(ERR_PAREN_MISMATCH);
+        c.reduce();
+    }
+    if (c.depth != 1) throw std::runtime_error(ERR_EXTRA_OPERAND);
+    return std::move(c.prog);
+}
+
+double run_program(const Program &prog, const double *vars) {
+    double small[32] = {};
+    std::vector<double> big;
+    double *stack = small;
+    if (prog.max_stack > 32) {
+        big.resize(prog.max_stack);
+        stack = big.data();
+    }
+    int sp = 0;
+    for (const Instr &ins : prog.code) {
+        switch (ins.code) {
+        case OP_CONST:
+            stack[sp++] = prog.constants[ins.index];
+            break;
+        case OP_VAR:
+            stack[sp++] = vars[ins.index];
+            break;
+        case OP_ADD:
+            --sp;
+            stack[sp - 1] += stack[sp];
+            break;
+        case OP_SUB:
+            --sp;
+            stack[sp - 1] -= stack[sp];
+            break;
+        case OP_MUL:
+            --sp;
+            stack[sp - 1] *= stack[sp];
+            break;
+        case OP_DIV:
+            --sp;
+            if (stack[sp] == 0) throw std::runtime_error(ERR_DIV_ZERO);
+            stack[sp - 1] /= stack[sp];
+            break;
+        }
+    }
+    return stack[0];
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tokenizer.h"
+
+enum OpCode : unsigned char { OP_CONST, OP_VAR, OP_ADD, OP_SUB, OP_MUL, OP_DIV };
+
+struct Instr {
+    OpCode code;
+    uint32_t index; // OP_CONST: constants 下标；OP_VAR: variables 下标
+};
+
+// 表达式编译后的后缀（逆波兰）指令序列
+struct Program {
+    std::vector<Instr> code;
+    std::vector<double> constants;
+    std::vector<std::string> variables;
+    int max_stack = 0;
+
+    int variable_index(const std::string &name) const;
+};
+
+OpCode opcode_for(char op);
+
+// 与 evaluate_expression 相同的双栈算法，只是输出指令而不计算；结构错误同样抛出 std::runtime_error
+Program compile_expression(const std::vector<Token> &token_list);
+
+// 标量解释执行，vars 按 Program::variables 的顺序给出变量取值
+double run_program(const Program &prog, const double *vars);
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+
+#include "evaluator.h"
+#include "result_cache.h"
+
+ResultCache::ResultCache(size_t capacity, size_t shards)
+    : shards_(std::bit_ceil(std::max<size_t>(1, shards))) {
+    shard_capacity_ = std::max<size_t>(1, capacity / shards_.size());
+    for (Shard &s : shards_) {
+        s.slots.resize(shard_capacity_);
+        s.referenced.resize(shard_capacity_);
+        s.index.reserve(shard_capacity_);
+    }
+}
+
+bool ResultCache::lookup(uint64_t key, std::string_view tokens, Entry &out) {
+    auto t0 = std::chrono::steady_clock::now();
+    Shard &s = shard_for(key);
+    bool hit = false;
+    {
+        std::lock_guard lock(s.mtx);
+        auto it = s.index.find(key);
+        if (it != s.index.end() && s.slots[it->second].tokens == tokens) {
+            const Entry &e = s.slots[it->second];
+            out.key = e.key;
+            out.ok = e.ok;
+            out.code = e.code;
+            out.token_index = e.token_index;
+            out.value = e.value;
+            s.referenced[it->second] = 1;
+            hit = true;
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    lookup_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count(),
+                         std::memory_order_relaxed);
+    (hit ? hits_ : misses_).fetch_add(1, std::memory_order_relaxed);
+    return hit;
+}
+
+void ResultCache::insert(Entry entry) {
+    Shard &s = shard_for(entry.key);
+    std::lock_guard lock(s.mtx);
+    auto it = s.index.find(entry.key);
+    if (it != s.index.end()) {
+        s.slots[it->second] = std::move(entry);
+        return;
+    }
+    size_t slot;
+    if (s.used < shard_capacity_) {
+        slot = s.used++;
+    } else {
+        while (s.referenced[s.hand]) {
+            s.referenced[s.hand] = 0;
+            s.hand = (s.hand + 1) % shard_capacity_;
+        }
+        slot = s.hand;
+        s.hand = (s.hand + 1) % shard_capacity_;
+        s.index.erase(s.slots[slot].key);
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    uint64_t key = entry.key;
+    s.slots[slot] = std::move(entry);
+    s.referenced[slot] = 0;
+    s.index.emplace(key, (uint32_t)slot);
+    insertions_.fetch_add(1, std::memory_order_relaxed);
+}
+
+CacheStats ResultCache::stats() const {
+    CacheStats st;
+    st.hits = hits_.load();
+    st.misses = misses_.load();
+    st.insertions = insertions_.load();
+    st.evictions = evictions_.load();
+    st.capacity = shard_capacity_ * shards_.size();
+    for (const Shard &s : shards_) {
+        std::lock_guard lock(s.mtx);
+        st.entries += s.used;
+        // 哈希表按每个结点 key + value + next 指针 + 桶指针估算
+        // 超出短字符串缓冲的记号字节单独分配在堆上
+        for (size_t i = 0; i < s.used; ++i)
+            if (s.slots[i].tokens.capacity() > std::string().capacity())
+                st.memory_bytes += s.slots[i].tokens.capacity() + 1;
+        st.memory_bytes += s.slots.capacity() * sizeof(Entry) + s.referenced.capacity() +
+                           s.index.size() * (sizeof(uint64_t) + sizeof(uint32_t) + 2 * sizeof(void *)) +
+                           s.index.bucket_count() * sizeof(void *);
+    }
+    uint64_t lookups = st.hits + st.misses;
+    st.avg_lookup_ns = lookups ? double(lookup_ns_.load()) / double(lookups) : 0.0;
+    return st;
+}
+
+std::string format_cache_stats(const CacheStats &st) {
+    return "cache: hits=" + std::to_string(st.hits) + " misses=" + std::to_string(st.misses) +
+           " hit_rate=" + std::to_string(st.hit_rate() * 100) + "% entries=" + std::to_string(st.entries) + "/" +
+           std::to_string(st.capacity) + " evictions=" + std::to_string(st.evictions) +
+           " memory=" + std::to_string(st.memory_bytes / 1024) + "KB avg_lookup=" + std::to_string(st.avg_lookup_ns) +
+           "ns";
+}
+
+void canonical_tokens(const std::vector<Token> &token_list, std::string &out) {
+    out.clear();
+    for (const Token &t : token_list) {
+        out.push_back(char(t.type));
+        if (t.type == NUMBER)
+            out.append(reinterpret_cast<const char *>(&t.value), sizeof(t.value));
+        else if (t.type == VARIABLE)
+            out.append(t.name).push_back('\0');
+        else
+            out.push_back(t.op);
+    }
+}
+
+EvalResult<double> cached_evaluate(ResultCache &cache, std::string_view expr, std::vector<Token> &token_list) {
+    uint64_t key;
+    auto tr = tokenize(expr, token_list, &key);
+    if (!tr) return std::unexpected(tr.error());
+    bool has_var = std::any_of(token_list.begin(), token_list.end(), [](const Token &t) { return t.type == VARIABLE; });
+    if (has_var) return try_evaluate_expression(token_list);
+
+    uint32_t count = (uint32_t)token_list.size();
+    thread_local std::string canonical;
+    canonical_tokens(token_list, canonical);
+    ResultCache::Entry e;
+    if (cache.lookup(key, canonical, e)) {
+        if (e.ok) return e.value;
+        uint32_t pos = e.token_index < count ? token_list[e.token_index].pos : 0;
+        return std::unexpected(EvalError{e.code, pos});
+    }
+
+    auto r = try_evaluate_expression(token_list);
+    e = {key, canonical, bool(r), E_BAD_NUMBER, 0, 0.0};
+    if (r) {
+        e.value = *r;
+    } else {
+        // 错误位置保存为记号下标，使缓存结果与空白无关
+        e.code = r.error().code;
+        auto it = std::lower_bound(token_list.begin(), token_list.end(), r.error().pos,
+                                   [](const Token &t, uint32_t p) { return t.pos < p; });
+        e.token_index = uint32_t(it - token_list.begin());
+    }
+    cache.insert(std::move(e));
+    return r;
+}
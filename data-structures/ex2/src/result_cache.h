@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "errors.h"
+#include "tokenizer.h"
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t insertions = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t capacity = 0;
+    size_t memory_bytes = 0;
+    double avg_lookup_ns = 0.0;
+
+    double hit_rate() const { return hits + misses ? double(hits) / double(hits + misses) : 0.0; }
+};
+
+// 以规范记号流哈希为键的有界结果缓存。按哈希分片，每片一把锁，
+// 片内用 CLOCK 近似 LRU：命中只置引用位，淘汰时时钟指针跳过并清除引用位。
+class ResultCache {
+public:
+    struct Entry {
+        uint64_t key = 0;
+        // 规范记号流的字节表示（数字存其二进制位，其余存字符）。命中时与本次输入逐字节比较，
+        // 哈希碰撞只会当作未命中，不会取回别的表达式的结果
+        std::string tokens;
+        bool ok = false;
+        ErrorCode code = E_BAD_NUMBER;
+        uint32_t token_index = 0; // 出错记号的下标，取回时换算成当前输入中的位置
+        double value = 0.0;
+    };
+
+    explicit ResultCache(size_t capacity = 1 << 16, size_t shards = 16);
+
+    // 命中时只填 out 的结果字段，不复制 tokens
+    bool lookup(uint64_t key, std::string_view tokens, Entry &out);
+    // 同一哈希已有条目时覆盖（碰撞时新表达式顶替旧的）
+    void insert(Entry entry);
+
+    CacheStats stats() const;
+
+private:
+    struct Shard {
+        mutable std::mutex mtx;
+        std::vector<Entry> slots;
+        std::vector<unsigned char> referenced;
+        std::unordered_map<uint64_t, uint32_t> index;
+        size_t used = 0;
+        size_t hand = 0;
+    };
+
+    Shard &shard_for(uint64_t key) { return shards_[(key >> 32) & (shards_.size() - 1)]; }
+
+    std::vector<Shard> shards_;
+    size_t shard_capacity_;
+    std::atomic<uint64_t> hits_{0}, misses_{0}, insertions_{0}, evictions_{0}, lookup_ns_{0};
+};
+
+std::string format_cache_stats(const CacheStats &st);
+
+// 记号流的规范字节表示，与 tokenize 的规范哈希取同样的信息；out 先清空，容量复用
+void canonical_tokens(const std::vector<Token> &token_list, std::string &out);
+
+// 对不含变量的表达式先查缓存，未命中再求值并写回；含变量的表达式直接求值
+EvalResult<double> cached_evaluate(ResultCache &cache, std::string_view expr, std::vector<Token> &token_list);
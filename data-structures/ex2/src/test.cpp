@@ -0,0 +1,253 @@
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "dag.h"
+#include "errors.h"
+#include "formula_graph.h"
+#include "evaluator.h"
+#include "jit.h"
+#include "program.h"
+#include "result_cache.h"
+#include "tokenizer.h"
+
+std::string random_formula(std::mt19937 &rng, int depth) {
+    std::uniform_int_distribution<int> pick(0, 9), op(0, 3), var(0, 3), num(0, 20);
+    if (depth == 0 || pick(rng) < 3) {
+        if (pick(rng) < 5) return std::string(1, char('a' + var(rng)));
+        return std::to_string(num(rng)) + (pick(rng) < 3 ? ".5" : "");
+    }
+    std::string l = random_formula(rng, depth - 1), r = random_formula(rng, depth - 1);
+    std::string s = l + " " + "+-*/"[op(rng)] + " " + r;
+    return pick(rng) < 4 ? "(" + s + ")" : s;
+}
+
+// 把变量替换为数字后交给原有的双栈求值，作为参照结果
+bool reference_eval(const std::vector<Token> &tokens, const Program &prog, const double *vars, double &out) {
+    std::vector<Token> bound = tokens;
+    for (auto &t : bound)
+        if (t.type == VARIABLE) t = Token(NUMBER, vars[prog.variable_index(std::string(t.name))]);
+    try {
+        out = evaluate_expression(bound);
+        return true;
+    } catch (const std::runtime_error &e) {
+        assert(e.what() == ERR_DIV_ZERO);
+        return false;
+    }
+}
+
+void test_tokenizer() {
+    std::vector<Token> buf;
+    assert(tokenize("1 + 2.5*(x_1)", buf) && buf.size() == 7);
+    assert(buf[2].type == NUMBER && buf[2].value == 2.5 && buf[2].pos == 4);
+    assert(buf[5].type == VARIABLE && buf[5].name == "x_1" && buf[5].pos == 9);
+    auto r = tokenize("1.2.3", buf);
+    assert(!r && r.error().code == E_MULTIPLE_DOT && r.error().pos == 3);
+    r = tokenize("3 $ 4", buf);
+    assert(!r && r.error().code == E_ILLEGAL_CHAR && r.error().pos == 2);
+    assert(error_message(r.error()) == ERR_ILLEGAL_CHAR + "$");
+    assert(tokenize(" . ", buf).error().code == E_BAD_NUMBER);
+    std::cout << "All tests passed for tokenizer" << std::endl;
+}
+
+void test_jit() {
+    std::cout << "Testing jit (" << (jit_supported() ? "native" : "interpreter fallback") << ")" << std::endl;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> val(-3, 3);
+    size_t div_zero = 0;
+    for (int n = 0; n < 2000; ++n) {
+        std::string src = random_formula(rng, 5);
+        auto tokens = tokenize_expression(src);
+        Program prog = compile_expression(tokens);
+        JitExpression jit(prog);
+        assert(jit.compiled() == (jit_supported() && prog.max_stack <= 15));
+        for (int k = 0; k < 10; ++k) {
+            double vars[4];
+            for (double &v : vars)
+                v = val(rng) * 0.5;
+            double expect, got;
+            bool ok = reference_eval(tokens, prog, vars, expect);
+            int rc = jit.call(vars, &got);
+            assert(ok == (rc == 0));
+            if (ok) {
+                assert(got == expect || (got != got && expect != expect));
+                assert(run_program(prog, vars) == got || got != got);
+            } else {
+                ++div_zero;
+                try {
+                    jit(vars);
+                    assert(false);
+                } catch (const std::runtime_error &e) {
+                    assert(e.what() == ERR_DIV_ZERO);
+                }
+            }
+        }
+    }
+    std::cout << "All tests passed for jit (" << div_zero << " division-by-zero cases)" << std::endl;
+}
+
+void test_dag() {
+    std::cout << "Testing dag" << std::endl;
+    std::vector<Token> buf;
+    auto build = [&](const char *src) { return ExprDag::build(compile_expression(tokenize_expression(src))); };
+    assert(build("(3 * 4) + a").size() == 3);
+    assert(build("(a + b) * (b + a)").size() == 4);
+    assert(build("a * 1 / 1 - 0").size() == 1);
+    assert(build("a + 0").size() == 3);   // a + 0 对 a = -0 不成立，不能化简
+    assert(build("a * 0").size() == 3);   // a * 0 对 Inf/NaN 不成立
+    assert(build("a / 4").nodes().back().kind == DAG_MUL);
+    ExprDag div0 = build("a / (2 - 2)");
+    double one = 1.0;
+    try {
+        div0.evaluate(&one);
+        assert(false);
+    } catch (const std::runtime_error &e) {
+        assert(e.what() == ERR_DIV_ZERO);
+    }
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> val(-3, 3);
+    for (int n = 0; n < 2000; ++n) {
+        Program prog = compile_expression(tokenize_expression(random_formula(rng, 5)));
+        ExprDag plain = ExprDag::build(prog, false), opt = ExprDag::build(prog);
+        assert(plain.size() == prog.code.size() && opt.size() <= plain.size());
+        for (int k = 0; k < 10; ++k) {
+            double vars[4];
+            for (double &v : vars)
+                v = val(rng) * 0.5;
+            bool ok = true;
+            double expect = 0;
+            try {
+                expect = run_program(prog, vars);
+            } catch (const std::runtime_error &) {
+                ok = false;
+            }
+            for (const ExprDag *d : {&plain, &opt}) {
+                try {
+                    double got = d->evaluate(vars);
+                    assert(ok && (got == expect || (got != got && expect != expect)));
+                } catch (const std::runtime_error &) {
+                    assert(!ok);
+                }
+            }
+        }
+    }
+    std::cout << "All tests passed for dag" << std::endl;
+}
+
+void test_formula_graph() {
+    std::cout << "Testing formula_graph" << std::endl;
+    FormulaGraph g(2);
+    g.set_input("a", 2);
+    g.define("b", "a * 3");
+    g.define("c", "b + a");
+    g.define("d", "a / (a - 2)");
+    g.set_input("x", 1);
+    g.define("y", "x + 1");
+    assert(g.recompute() == 4);
+    assert(g.get("c").value == 8 && g.get("d").error == ERR_DIV_ZERO);
+
+    g.set_input("a", 3);
+    assert(g.recompute() == 3); // y 不受影响
+    assert(g.get("c").value == 12 && g.get("d").value == 3);
+
+    try {
+        g.define("a", "c + 1");
+        assert(false);
+    } catch (const std::runtime_error &) {
+    }
+    assert(g.get("a").value == 3);
+
+    g.define("e", "zz + 1");
+    assert(g.get("e").error == ERR_UNBOUND_VAR + "zz");
+    g.set_input("zz", 1);
+    assert(g.get("e").value == 2);
+
+    g.define("c", "y * 10"); // 改变依赖后 a 的变化不再影响 c
+    g.recompute();
+    g.set_input("a", 4);
+    assert(g.recompute() == 2 && g.get("c").value == 20);
+    std::cout << "All tests passed for formula_graph" << std::endl;
+}
+
+void test_error_codes() {
+    std::cout << "Testing error codes" << std::endl;
+    struct Case {
+        const char *expr;
+        ErrorCode code;
+        uint32_t pos;
+    };
+    const Case cases[] = {
+        {"1 + 2 / (3 - 3)", E_DIV_ZERO, 6}, {"(1 + 2", E_PAREN_MISMATCH, 0}, {"1 + 2)", E_PAREN_MISMATCH, 5},
+        {"1 + * 2", E_MISSING_OPERAND, 2},  {"1 2", E_EXTRA_OPERAND, 2},      {"", E_EXTRA_OPERAND, 0},
+        {"1 + y", E_UNBOUND_VAR, 4},
+    };
+    std::vector<Token> buf;
+    for (const Case &c : cases) {
+        auto r = try_evaluate(c.expr, buf);
+        assert(!r && r.error().code == c.code && r.error().pos == c.pos);
+        try {
+            evaluate_expression(tokenize_expression(c.expr));
+            assert(false);
+        } catch (const std::runtime_error &e) {
+            assert(e.what() == error_message(r.error()));
+        }
+    }
+    assert(*try_evaluate_expression(tokenize_expression("(1 + 2) * 3")) == 9);
+    assert(try_apply_operator(1, 0, '/', 7).error().pos == 7);
+    std::cout << "All tests passed for error codes" << std::endl;
+}
+
+void test_result_cache() {
+    std::cout << "Testing result_cache" << std::endl;
+    ResultCache cache(4, 1);
+    std::vector<Token> buf;
+    uint64_t h1, h2, h3;
+    tokenize("1+2 *3", buf, &h1);
+    tokenize(" 1 + 2*3.0 ", buf, &h2);
+    tokenize("1+2*4", buf, &h3);
+    assert(h1 == h2 && h1 != h3);
+
+    assert(*cached_evaluate(cache, "1+2 *3", buf) == 7);
+    assert(*cached_evaluate(cache, "1 + 2 * 3", buf) == 7);
+    auto r = cached_evaluate(cache, "1/(2-2)", buf);
+    assert(!r && r.error().code == E_DIV_ZERO && r.error().pos == 1);
+    r = cached_evaluate(cache, "1  /  (2-2)", buf); // 命中缓存，位置按本次输入换算
+    assert(!r && r.error().code == E_DIV_ZERO && r.error().pos == 3);
+    CacheStats st = cache.stats();
+    assert(st.hits == 2 && st.misses == 2 && st.entries == 2);
+
+    // 哈希相同而记号不同（模拟碰撞）只能算未命中
+    std::string canon;
+    tokenize("5*5", buf, &h3);
+    canonical_tokens(buf, canon);
+    ResultCache::Entry e;
+    assert(cache.lookup(h1, canon, e) == false);
+    cache.insert({h1, canon, true, E_BAD_NUMBER, 0, 25.0});
+    assert(*cached_evaluate(cache, "1+2*3", buf) == 7);
+    assert(cache.lookup(h1, canon, e) == false); // 上一行未命中后写回，顶替了伪造的条目
+    tokenize("1+2*3", buf, &h2);
+    canonical_tokens(buf, canon);
+    assert(cache.lookup(h1, canon, e) && e.ok && e.value == 7);
+    st = cache.stats();
+    assert(st.hits == 3 && st.misses == 5);
+
+    for (int i = 0; i < 10; ++i)
+        cached_evaluate(cache, std::to_string(i) + "+1", buf);
+    st = cache.stats();
+    assert(st.entries == 4 && st.evictions == 8);
+    std::cout << "All tests passed for result_cache" << std::endl;
+}
+
+int main() {
+    test_tokenizer();
+    test_error_codes();
+    test_jit();
+    test_dag();
+    test_formula_graph();
+    test_result_cache();
+    return 0;
+}
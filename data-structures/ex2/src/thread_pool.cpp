@@ -0,0 +1,76 @@
+#include <algorithm>
+
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (!threads) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 1; i < threads; ++i)
+        workers_.emplace_back([this] { worker_loop(); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mtx_);
+        stop_ = true;
+    }
+    cv_start_.notify_all();
+    for (auto &t : workers_)
+        t.join();
+}
+
+void ThreadPool::run_chunks(const std::function<void(size_t, size_t)> &job, size_t n, size_t grain) {
+    while (true) {
+        size_t begin = next_.fetch_add(grain);
+        if (begin >= n) return;
+        job(begin, std::min(n, begin + grain));
+    }
+}
+
+void ThreadPool::worker_loop() {
+    size_t seen = 0;
+    while (true) {
+        // 任务与代号在同一把锁下取出：醒得晚的线程要么拿到当前这一代的完整任务，
+        // 要么（上一代已经结束、job_ 已清空）什么也不做，不会读到下一代写了一半的字段
+        const std::function<void(size_t, size_t)> *job;
+        size_t n, grain;
+        {
+            std::unique_lock lock(mtx_);
+            cv_start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+            job = job_;
+            n = n_;
+            grain = grain_;
+            if (!job) continue;
+            ++active_;
+        }
+        run_chunks(*job, n, grain);
+        {
+            std::lock_guard lock(mtx_);
+            --active_;
+        }
+        cv_done_.notify_one();
+    }
+}
+
+void ThreadPool::parallel_for(size_t n, size_t grain, const std::function<void(size_t, size_t)> &fn) {
+    if (!n) return;
+    grain = std::max<size_t>(1, grain);
+    if (workers_.empty() || n <= grain) {
+        fn(0, n);
+        return;
+    }
+    {
+        std::lock_guard lock(mtx_);
+        job_ = &fn;
+        n_ = n;
+        grain_ = grain;
+        next_ = 0;
+        ++generation_;
+    }
+    cv_start_.notify_all();
+    run_chunks(fn, n, grain);
+    std::unique_lock lock(mtx_);
+    cv_done_.wait(lock, [&] { return active_ == 0 && next_ >= n_; });
+    job_ = nullptr;
+}
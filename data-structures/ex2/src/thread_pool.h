@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 常驻线程池，只提供阻塞式的 parallel_for，调用线程也参与计算
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned size() const { return (unsigned)workers_.size() + 1; }
+
+    // 把 [0, n) 按 grain 切块，并行执行 fn(begin, end)，全部完成后返回
+    void parallel_for(size_t n, size_t grain, const std::function<void(size_t, size_t)> &fn);
+
+private:
+    void worker_loop();
+    void run_chunks(const std::function<void(size_t, size_t)> &job, size_t n, size_t grain);
+
+    std::vector<std::thread> workers_;
+    std::mutex mtx_;
+    std::condition_variable cv_start_, cv_done_;
+    const std::function<void(size_t, size_t)> *job_ = nullptr;
+    size_t n_ = 0, grain_ = 1;
+    std::atomic<size_t> next_{0};
+    size_t generation_ = 0;
+    unsigned active_ = 0;
+    bool stop_ = false;
+};
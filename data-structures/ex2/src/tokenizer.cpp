@@ -0,0 +1,123 @@
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+
+#include "errors.h"
+#include "tokenizer.h"
+
+namespace {
+
+enum CharClass : unsigned char { CC_ILLEGAL, CC_SPACE, CC_DIGIT, CC_DOT, CC_OPERATOR, CC_PAREN, CC_ALPHA };
+
+constexpr std::array<unsigned char, 256> make_char_table() {
+    std::array<unsigned char, 256> table{};
+    for (unsigned char c : {' ', '\t', '\n', '\v', '\f', '\r'})
+        table[c] = CC_SPACE;
+    for (unsigned char c = '0'; c <= '9'; ++c)
+        table[c] = CC_DIGIT;
+    for (unsigned char c = 'a'; c <= 'z'; ++c)
+        table[c] = CC_ALPHA;
+    for (unsigned char c = 'A'; c <= 'Z'; ++c)
+        table[c] = CC_ALPHA;
+    table['_'] = CC_ALPHA;
+    table['.'] = CC_DOT;
+    for (unsigned char c : {'+', '-', '*', '/'})
+        table[c] = CC_OPERATOR;
+    table['('] = CC_PAREN;
+    table[')'] = CC_PAREN;
+    return table;
+}
+
+constexpr std::array<unsigned char, 256> CHAR_TABLE = make_char_table();
+
+inline unsigned char char_class(char c) { return CHAR_TABLE[static_cast<unsigned char>(c)]; }
+
+inline uint64_t hash_mix(uint64_t h, uint64_t x) {
+    h ^= x + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    return h * 0xff51afd7ed558ccdULL;
+}
+
+uint64_t hash_token(uint64_t h, const Token &t) {
+    h = hash_mix(h, t.type);
+    switch (t.type) {
+    case NUMBER: {
+        uint64_t bits;
+        std::memcpy(&bits, &t.value, sizeof(bits));
+        return hash_mix(h, bits);
+    }
+    case VARIABLE:
+        for (char c : t.name)
+            h = hash_mix(h, (unsigned char)c);
+        return hash_mix(h, t.name.size());
+    default:
+        return hash_mix(h, (unsigned char)t.op);
+    }
+}
+
+} // namespace
+
+EvalResult<void> tokenize(std::string_view expr, std::vector<Token> &token_list, uint64_t *hash) {
+    token_list.clear();
+    const char *begin = expr.data();
+    const char *end = begin + expr.size();
+    const char *p = begin;
+    while (p < end) {
+        switch (char_class(*p)) {
+        case CC_SPACE:
+            ++p;
+            break;
+        case CC_DIGIT:
+        case CC_DOT: {
+            const char *start = p;
+            const char *dot = nullptr;
+            unsigned char cc;
+            while (p < end && ((cc = char_class(*p)) == CC_DIGIT || cc == CC_DOT)) {
+                if (cc == CC_DOT) {
+                    if (dot) return std::unexpected(EvalError{E_MULTIPLE_DOT, uint32_t(p - begin)});
+                    dot = p;
+                }
+                ++p;
+            }
+            double val;
+            auto [ptr, ec] = std::from_chars(start, p, val);
+            if (ec != std::errc() || ptr != p) return std::unexpected(EvalError{E_BAD_NUMBER, uint32_t(start - begin)});
+            token_list.emplace_back(NUMBER, val, uint32_t(start - begin));
+            break;
+        }
+        case CC_ALPHA: {
+            const char *start = p;
+            unsigned char cc;
+            while (p < end && ((cc = char_class(*p)) == CC_ALPHA || cc == CC_DIGIT))
+                ++p;
+            token_list.emplace_back(VARIABLE, std::string_view(start, p - start), uint32_t(start - begin));
+            break;
+        }
+        case CC_OPERATOR:
+            token_list.emplace_back(OPERATOR, *p, uint32_t(p - begin));
+            ++p;
+            break;
+        case CC_PAREN:
+            token_list.emplace_back(PARENTHESIS, *p, uint32_t(p - begin));
+            ++p;
+            break;
+        default:
+            return std::unexpected(EvalError{E_ILLEGAL_CHAR, uint32_t(p - begin), std::string_view(p, 1)});
+        }
+    }
+    if (hash) {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (const Token &t : token_list)
+            h = hash_token(h, t);
+        *hash = hash_mix(h, token_list.size());
+    }
+    return {};
+}
+
+std::vector<Token> tokenize_expression(const std::string &expr) {
+    std::vector<Token> token_list;
+    auto r = tokenize(expr, token_list);
+    if (!r) throw std::runtime_error(error_message(r.error()));
+    return token_list;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "errors.h"
+
+enum TokenType { NUMBER, OPERATOR, PARENTHESIS, VARIABLE };
+
+struct Token {
+    TokenType type;
+    uint32_t pos = 0; // 在输入中的起始下标
+    union {
+        double value;
+        char op;
+        std::string_view name; // 指向输入字符串，调用方需保证其生命周期
+    };
+    Token(TokenType t, double v, uint32_t p = 0) : type(t), pos(p), value(v) {}
+    Token(TokenType t, char o, uint32_t p = 0) : type(t), pos(p), op(o) {}
+    Token(TokenType t, std::string_view n, uint32_t p = 0) : type(t), pos(p), name(n) {}
+};
+
+// 不抛异常、不分配内存的分词：结果写入调用方提供的 token_list（先清空，容量复用）。
+// hash 非空时顺带计算记号流的规范哈希，与空白和数字写法（如 1 与 1.0）无关
+EvalResult<void> tokenize(std::string_view expr, std::vector<Token> &token_list, uint64_t *hash = nullptr);
+
+// 旧接口：出错时抛出 std::runtime_error
+std::vector<Token> tokenize_expression(const std::string &expr);
@@ -1,145 +1,148 @@
 #include <algorithm>
-#include <functional>
+#include <climits>
+#include <cstdint>
 #include <iostream>
-#include <queue>
-#include <sstream>
 #include <vector>
 
 #include "ascii_printer.h"
 
-void printAsciiBoxed(const BinaryTree<char> &tree, int pad) {
-    using Node = BinaryTree<char>::Node;
-    Node *root = tree.getRoot();
-    if (!root) {
-        std::cout << "╔══╗\n";
-        std::cout << "║  ║\n";
-        std::cout << "╚══╝\n";
-        return;
+namespace {
+
+using Node = BinaryTree<char>::Node;
+
+// 第 row 行的一段：[begin, end) 列重复同一字形；glyph 为空时是结点值 ch
+struct Span {
+    size_t row;
+    long begin, end;
+    const char *glyph;
+    char ch;
+};
+
+// 只收集视口内的片段，超出窗口的部分直接裁掉；同一行的片段按列递增产生，
+// 输出前按行稳定排序即可逐行拼接。没有可见内容的行不占空间
+class Canvas {
+public:
+    Canvas(long begin, long end) : begin(begin), end(end) {}
+
+    void put(size_t row, long from, long to, const char *glyph, char ch = 0) {
+        from = std::max(from, begin);
+        to = std::min(to, end);
+        if (from < to)
+            spans.push_back({row, from, to, glyph, ch});
+    }
+
+    std::vector<Span> &sorted() {
+        std::stable_sort(spans.begin(), spans.end(), [](const Span &a, const Span &b) { return a.row < b.row; });
+        return spans;
     }
 
-    std::function<int(const Node *)> height = [&](const Node *n) -> int {
-        if (!n)
-            return 0;
-        return 1 + std::max(height(n->left.get()), height(n->right.get()));
+private:
+    long begin, end;
+    std::vector<Span> spans;
+};
+
+struct Frame {
+    const Node *n;
+    int depth;
+    size_t parentSlot; // 左孩子：父结点在栈中的下标
+    long parentX;      // 右孩子：父结点的中序位置
+    long leftX;        // 左孩子访问后回填的中序位置
+};
+
+constexpr size_t NO_SLOT = SIZE_MAX;
+
+} // namespace
+
+// 中序遍历视口内的层，栈深 O(高度)；位于窗口右侧之后只需收尾祖先的左连线，不再进入右子树。
+// 第 d 层结点画在第 2d 行，它到孩子的连线画在第 2d + 1 行。
+std::string renderAscii(const BinaryTree<char> &tree, const AsciiViewport &view, int pad) {
+    const Node *root = view.root ? view.root : tree.getRoot();
+    if (!root)
+        return "╔══╗\n║  ║\n╚══╝\n";
+
+    int limit = view.maxDepth > 0 ? view.maxDepth : INT32_MAX;
+    long colBegin = std::max(0L, view.colBegin);
+    long colEnd = view.colEnd < 0 ? LONG_MAX / 4 : view.colEnd;
+    Canvas canvas(2 * colBegin, 2 * colEnd - 1);
+
+    std::vector<Frame> stack;
+    auto pushLeftChain = [&](const Node *n, int depth, long parentX) {
+        size_t parentSlot = NO_SLOT;
+        for (; n && depth < limit; n = n->left.get(), ++depth) {
+            stack.push_back({n, depth, parentSlot, parentX, -1});
+            parentSlot = stack.size() - 1;
+            parentX = -1;
+        }
     };
-    int h = height(root);
-
-    int rows = h * 2 - 1;
-    int colsCells = (1 << h) * 2;
-
-    std::vector<std::vector<const Node *>> levels(h);
-    std::queue<const Node *> q;
-    q.push(root);
-    for (int lvl = 0; lvl < h; ++lvl) {
-        int cnt = 1 << lvl;
-        for (int i = 0; i < cnt; ++i) {
-            const Node *n = nullptr;
-            if (!q.empty()) {
-                n = q.front();
-                q.pop();
-            }
-            levels[lvl].push_back(n);
-            if (n) {
-                q.push(n->left.get());
-                q.push(n->right.get());
-            } else {
-                q.push(nullptr);
-                q.push(nullptr);
-            }
+    pushLeftChain(root, 0, -1);
+
+    long x = 0;
+    while (!stack.empty()) {
+        Frame f = stack.back();
+        stack.pop_back();
+        long cx = x++;
+        size_t row = 2 * (size_t)f.depth;
+        if (f.parentX >= 0) {
+            canvas.put(row - 1, 2 * f.parentX + 1, 2 * cx, "─");
+            canvas.put(row - 1, 2 * cx, 2 * cx + 1, "┐");
+        } else if (f.parentSlot != NO_SLOT) {
+            stack[f.parentSlot].leftX = cx;
         }
-    }
+        canvas.put(row, 2 * cx, 2 * cx + 1, nullptr, f.n->val);
 
-    std::vector<std::vector<std::string>> gridCells(rows, std::vector<std::string>(colsCells, " "));
-    std::vector<std::vector<int>> pos(h);
-
-    for (int lvl = 0; lvl < h; ++lvl) {
-        int nodes = (int)levels[lvl].size();
-        int gap = colsCells / (nodes * 2);
-        pos[lvl].resize(nodes);
-        for (int i = 0; i < nodes; ++i) {
-            int col = (2 * i + 1) * gap;
-            int row = lvl * 2;
-            pos[lvl][i] = col;
-            const Node *node = levels[lvl][i];
-            if (node && row >= 0 && row < rows && col >= 0 && col < colsCells) {
-                gridCells[row][col] = std::string(1, node->val);
-            }
+        bool showLeft = f.leftX >= 0;
+        bool showRight = f.n->right && f.depth + 1 < limit && cx < colEnd;
+        if (showLeft) {
+            canvas.put(row + 1, 2 * f.leftX, 2 * f.leftX + 1, "┌");
+            canvas.put(row + 1, 2 * f.leftX + 1, 2 * cx, "─");
         }
+        if (showLeft || showRight)
+            canvas.put(row + 1, 2 * cx, 2 * cx + 1, showLeft && showRight ? "┴" : showLeft ? "┘" : "└");
+        if (showRight)
+            pushLeftChain(f.n->right.get(), f.depth + 1, cx);
     }
 
-    for (int lvl = 0; lvl < h - 1; ++lvl) {
-        int nodes = (int)levels[lvl].size();
-        int connRow = lvl * 2 + 1;
-        for (int i = 0; i < nodes; ++i) {
-            const Node *node = levels[lvl][i];
-            if (!node)
-                continue;
-            int pcol = pos[lvl][i];
-            int leftIdx = 2 * i;
-            int rightIdx = 2 * i + 1;
-            bool hasLeft = (leftIdx < (int)pos[lvl + 1].size() && levels[lvl + 1][leftIdx]);
-            bool hasRight = (rightIdx < (int)pos[lvl + 1].size() && levels[lvl + 1][rightIdx]);
-            int lcol = hasLeft ? pos[lvl + 1][leftIdx] : -1;
-            int rcol = hasRight ? pos[lvl + 1][rightIdx] : -1;
-
-            if (hasLeft && hasRight) {
-                int start = std::min(lcol, pcol);
-                if (start >= 0 && pcol < colsCells) {
-                    gridCells[connRow][start] = "┌";
-                    for (int c = start + 1; c < pcol; ++c)
-                        gridCells[connRow][c] = "─";
-                    gridCells[connRow][pcol] = "┴";
-                }
-                if (pcol >= 0 && rcol < colsCells) {
-                    gridCells[connRow][pcol] = "┴";
-                    for (int c = pcol + 1; c < rcol; ++c)
-                        gridCells[connRow][c] = "─";
-                    gridCells[connRow][rcol] = "┐";
-                }
-            } else if (hasLeft && !hasRight) {
-                if (lcol >= 0 && pcol < colsCells) {
-                    int start = std::min(lcol, pcol);
-                    for (int c = start + 1; c < pcol; ++c)
-                        gridCells[connRow][c] = "─";
-                    gridCells[connRow][pcol] = "┘";
-                    gridCells[connRow][lcol] = "┌";
-                }
-            } else if (!hasLeft && hasRight) {
-                if (rcol >= 0 && pcol >= 0) {
-                    for (int c = pcol + 1; c < rcol; ++c)
-                        gridCells[connRow][c] = "─";
-                    gridCells[connRow][pcol] = "└";
-                    gridCells[connRow][rcol] = "┐";
-                }
+    // 窗口右侧被截断时 x 只数到截断处，列宽取窗口宽；只输出首末可见行之间的行
+    long width = std::max(0L, 2 * std::min(colEnd, x) - 1 - 2 * colBegin);
+    const std::vector<Span> &spans = canvas.sorted();
+    size_t firstRow = spans.empty() ? 0 : spans.front().row;
+    size_t lastRow = spans.empty() ? 0 : spans.back().row;
+    std::string out;
+    out.reserve((lastRow - firstRow + 3) * (size_t)(width + 2 * pad + 4) * 3);
+    auto border = [&](const char *left, const char *right) {
+        out += left;
+        for (long i = 0; i <= width + 2 * pad; ++i)
+            out += "═";
+        out += right;
+        out += '\n';
+    };
+    border("╔", "╗");
+    auto it = spans.begin();
+    for (size_t r = firstRow; r <= lastRow; ++r) {
+        out += "║";
+        out.append(pad, ' ');
+        long cursor = 2 * colBegin;
+        for (; it != spans.end() && it->row == r; ++it) {
+            out.append(it->begin - cursor, ' ');
+            for (long c = it->begin; c < it->end; ++c) {
+                if (it->glyph)
+                    out += it->glyph;
+                else
+                    out += it->ch;
             }
+            cursor = it->end;
         }
+        out.append(std::max(0L, 2 * colBegin + width - cursor), ' ');
+        out.append(pad + 1, ' ');
+        out += "║\n";
     }
+    border("╚", "╝");
+    return out;
+}
 
-    std::vector<std::string> lines;
-    for (int r = 0; r < rows; ++r) {
-        std::ostringstream oss;
-        for (int c = 0; c < colsCells; ++c)
-            oss << gridCells[r][c];
-        lines.push_back(oss.str());
-    }
+void printAsciiBoxed(const BinaryTree<char> &tree, int pad) { printAsciiBoxed(tree, AsciiViewport{}, pad); }
 
-    int innerWidthCells = colsCells;
-    int totalInner = innerWidthCells + pad * 2;
-    std::cout << "╔";
-    for (int i = 0; i <= totalInner; ++i)
-        std::cout << "═";
-    std::cout << "╗\n";
-    for (const auto &ln : lines) {
-        std::cout << "║";
-        for (int i = 0; i < pad; ++i)
-            std::cout << ' ';
-        std::cout << ln;
-        for (int i = 0; i <= pad; ++i)
-            std::cout << ' ';
-        std::cout << "║\n";
-    }
-    std::cout << "╚";
-    for (int i = 0; i <= totalInner; ++i)
-        std::cout << "═";
-    std::cout << "╝\n";
+void printAsciiBoxed(const BinaryTree<char> &tree, const AsciiViewport &view, int pad) {
+    std::string frame = renderAscii(tree, view, pad);
+    std::cout.write(frame.data(), (std::streamsize)frame.size());
 }
@@ -1,5 +1,21 @@
 #pragma once
 
+#include <string>
+
 #include "binary_tree.h"
 
+// 视口：按中序位置横向排布，第 k 个中序结点画在第 2k 列；
+// 可只画某棵子树、前若干层、以及中序位置落在 [colBegin, colEnd) 的列，用于翻看大树
+struct AsciiViewport {
+    const BinaryTree<char>::Node *root = nullptr; // nullptr 为整棵树
+    int maxDepth = 0;                             // 0 为不限层数
+    long colBegin = 0;
+    long colEnd = -1;                             // -1 为不限
+};
+
+// 只保存视口内可见的结点和连线，内存与可见结点数成正比
+std::string renderAscii(const BinaryTree<char>& tree, const AsciiViewport& view = {}, int pad = 1);
+
+// 整帧渲染后一次写出
 void printAsciiBoxed(const BinaryTree<char>& tree, int pad = 1);
+void printAsciiBoxed(const BinaryTree<char>& tree, const AsciiViewport& view, int pad = 1);
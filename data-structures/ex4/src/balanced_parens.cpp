@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+
+#include "balanced_parens.h"
+
+namespace {
+
+// 按字节查表：正向扫描时字节内前缀和的最小值，反向扫描时后缀和的最大值，以及字节总和
+struct ByteTables {
+    std::array<int8_t, 256> fwdMin{}, bwdMax{}, total{};
+};
+
+constexpr ByteTables makeByteTables() {
+    ByteTables t;
+    for (int v = 0; v < 256; ++v) {
+        int s = 0, lo = 8;
+        for (int j = 0; j < 8; ++j) {
+            s += (v >> j) & 1 ? 1 : -1;
+            lo = std::min(lo, s);
+        }
+        t.fwdMin[v] = (int8_t)lo;
+        t.total[v] = (int8_t)s;
+        int suf = 0, hi = -8;
+        for (int j = 7; j >= 0; --j) {
+            suf += (v >> j) & 1 ? 1 : -1;
+            hi = std::max(hi, suf);
+        }
+        t.bwdMax[v] = (int8_t)hi;
+    }
+    return t;
+}
+
+constexpr ByteTables TABLES = makeByteTables();
+
+} // namespace
+
+size_t BalancedParens::leafCount(size_t length) {
+    return std::bit_ceil(std::max<size_t>(1, (length + BLOCK - 1) / BLOCK));
+}
+
+size_t BalancedParens::directoryWords(size_t length) { return length / SUPER + 1 + 2 * leafCount(length); }
+
+void BalancedParens::buildDirectory(const uint64_t *bits, size_t length, uint64_t *directory) {
+    size_t superCount = length / SUPER + 1;
+    uint64_t ones = 0;
+    for (size_t s = 0; s < superCount; ++s) {
+        directory[s] = ones;
+        size_t end = std::min(length, (s + 1) * SUPER);
+        for (size_t w = s * SUPER / 64; w * 64 < end; ++w)
+            ones += std::popcount(w * 64 + 64 <= end ? bits[w] : bits[w] & ((1ull << (end % 64)) - 1));
+    }
+
+    size_t leaves = leafCount(length);
+    int64_t *mins = reinterpret_cast<int64_t *>(directory + superCount);
+    std::fill(mins, mins + 2 * leaves, INT64_MAX);
+    int64_t e = 0;
+    for (size_t x = 0; x < length;) {
+        size_t b = x / BLOCK, end = std::min(length, x + BLOCK);
+        int64_t lo = INT64_MAX;
+        for (; x < end; ++x) {
+            e += (bits[x / 64] >> (x % 64)) & 1 ? 1 : -1;
+            lo = std::min(lo, e);
+        }
+        mins[leaves + b] = lo;
+    }
+    for (size_t node = leaves - 1; node >= 1; --node)
+        mins[node] = std::min(mins[2 * node], mins[2 * node + 1]);
+}
+
+BalancedParens::BalancedParens(const uint64_t *bits, size_t length, const uint64_t *directory)
+    : bits(bits), len(length), ranks(directory),
+      mins(reinterpret_cast<const int64_t *>(directory + length / SUPER + 1)), leaves(leafCount(length)) {}
+
+size_t BalancedParens::rank1(size_t i) const {
+    size_t r = ranks[i / SUPER];
+    for (size_t w = i / SUPER * SUPER / 64; w < i / 64; ++w)
+        r += std::popcount(bits[w]);
+    if (i % 64)
+        r += std::popcount(bits[i / 64] & ((1ull << (i % 64)) - 1));
+    return r;
+}
+
+size_t BalancedParens::select1(size_t k) const {
+    // 最后一个累计数 <= k 的超级块
+    size_t lo = 0, hi = len / SUPER;
+    while (lo < hi) {
+        size_t mid = (lo + hi + 1) / 2;
+        if (ranks[mid] <= k)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    size_t r = ranks[lo];
+    for (size_t w = lo * SUPER / 64; w * 64 < len; ++w) {
+        size_t c = std::popcount(bits[w]);
+        if (k - r < c) {
+            uint64_t word = bits[w];
+            for (size_t skip = k - r; skip; --skip)
+                word &= word - 1;
+            return w * 64 + std::countr_zero(word);
+        }
+        r += c;
+    }
+    return NONE;
+}
+
+bool BalancedParens::scanForward(size_t &x, int64_t &e, size_t end, int64_t target) const {
+    while (x < end) {
+        if (x % 8 == 0 && x + 8 <= end) {
+            unsigned byte = byteAt(x);
+            if (e + TABLES.fwdMin[byte] > target) {
+                e += TABLES.total[byte];
+                x += 8;
+                continue;
+            }
+        }
+        e += get(x) ? 1 : -1;
+        ++x;
+        if (e <= target)
+            return true;
+    }
+    return false;
+}
+
+bool BalancedParens::scanBackward(size_t &x, int64_t &e, size_t begin, int64_t target) const {
+    while (x > begin) {
+        if (x % 8 == 0 && x - 8 >= begin) {
+            unsigned byte = byteAt(x - 8);
+            if (e - TABLES.bwdMax[byte] > target) {
+                e -= TABLES.total[byte];
+                x -= 8;
+                continue;
+            }
+        }
+        --x;
+        e -= get(x) ? 1 : -1;
+        if (e <= target)
+            return true;
+    }
+    return false;
+}
+
+size_t BalancedParens::nextBlock(size_t b, int64_t target) const {
+    size_t node = leaves + b;
+    while (node > 1) {
+        if (!(node & 1) && mins[node + 1] <= target) {
+            node = node + 1;
+            while (node < leaves)
+                node = mins[2 * node] <= target ? 2 * node : 2 * node + 1;
+            return node - leaves;
+        }
+        node >>= 1;
+    }
+    return NONE;
+}
+
+size_t BalancedParens::prevBlock(size_t b, int64_t target) const {
+    size_t node = leaves + b;
+    while (node > 1) {
+        if ((node & 1) && mins[node - 1] <= target) {
+            node = node - 1;
+            while (node < leaves)
+                node = mins[2 * node + 1] <= target ? 2 * node + 1 : 2 * node;
+            return node - leaves;
+        }
+        node >>= 1;
+    }
+    return NONE;
+}
+
+// 先扫当前块剩余部分，再在线段树上找下一个最小超额够低的块，最后在该块内逐字节定位
+size_t BalancedParens::fwdSearch(size_t i, int64_t target) const {
+    if (i > len)
+        return NONE;
+    int64_t e = excess(i);
+    if (e <= target)
+        return i;
+    size_t x = i;
+    size_t end = std::min(len, (x / BLOCK + 1) * BLOCK);
+    if (scanForward(x, e, end, target))
+        return x;
+    if (end == len)
+        return NONE;
+    size_t b = nextBlock(end / BLOCK - 1, target);
+    if (b == NONE)
+        return NONE;
+    x = b * BLOCK;
+    e = excess(x);
+    scanForward(x, e, std::min(len, x + BLOCK), target);
+    return x;
+}
+
+size_t BalancedParens::bwdSearch(size_t i, int64_t target) const {
+    int64_t e = excess(i);
+    if (e <= target)
+        return i;
+    if (i == 0)
+        return NONE;
+    size_t x = i;
+    size_t begin = (i - 1) / BLOCK * BLOCK;
+    if (scanBackward(x, e, begin, target))
+        return x;
+    if (begin == 0)
+        return NONE;
+    // 位置 begin 已检查过；它所在叶子里更靠前的位置以及更早的叶子还没有
+    size_t c = begin / BLOCK - 1;
+    if (mins[leaves + c] > target)
+        c = prevBlock(c, target);
+    if (c == NONE)
+        return target >= 0 ? 0 : NONE;
+    x = (c + 1) * BLOCK;
+    e = excess(x);
+    if (e <= target)
+        return x;
+    scanBackward(x, e, c * BLOCK, target);
+    return x;
+}
+
+size_t BalancedParens::findClose(size_t p) const {
+    size_t x = fwdSearch(p + 1, excess(p));
+    return x == NONE ? NONE : x - 1;
+}
+
+size_t BalancedParens::enclose(size_t p) const {
+    if (p == 0)
+        return NONE;
+    return bwdSearch(p - 1, excess(p) - 1);
+}
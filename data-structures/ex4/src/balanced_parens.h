@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 平衡括号序列的只读视图：1 为左括号、0 为右括号，按 64 位字、低位在前存放。
+// 目录由两部分组成：每 512 位一个的累计 1 个数（rank/select），
+// 以及以 1024 位为叶、记录块内最小超额的线段树（range min-max tree，用于 findClose/enclose）。
+// 位串与目录都只是指针，可以直接指向 mmap 进来的文件内容。
+class BalancedParens {
+public:
+    static constexpr size_t NONE = SIZE_MAX;
+
+    BalancedParens() = default;
+    BalancedParens(const uint64_t *bits, size_t length, const uint64_t *directory);
+
+    static size_t directoryWords(size_t length);
+    static void buildDirectory(const uint64_t *bits, size_t length, uint64_t *directory);
+
+    size_t length() const { return len; }
+    bool get(size_t i) const { return (bits[i / 64] >> (i % 64)) & 1; }
+    // [0, i) 中 1 的个数
+    size_t rank1(size_t i) const;
+    // 第 k 个 1（从 0 数）的位置，O(log n)
+    size_t select1(size_t k) const;
+    // [0, i) 的超额（左括号数减右括号数）
+    int64_t excess(size_t i) const { return 2 * (int64_t)rank1(i) - (int64_t)i; }
+
+    // 与位置 p 的左括号匹配的右括号
+    size_t findClose(size_t p) const;
+    // 直接包含 p 处左括号的那对括号的左括号位置，p 在最外层时为 NONE
+    size_t enclose(size_t p) const;
+
+private:
+    static constexpr size_t SUPER = 512;
+    static constexpr size_t BLOCK = 1024;
+
+    const uint64_t *bits = nullptr;
+    size_t len = 0;
+    const uint64_t *ranks = nullptr;
+    const int64_t *mins = nullptr; // mins[1] 为根，叶子 mins[leaves + b] 覆盖位置 (BLOCK * b, BLOCK * (b + 1)]
+    size_t leaves = 1;
+
+    static size_t leafCount(size_t length);
+    // 最小的 x >= i 使 excess(x) <= target
+    size_t fwdSearch(size_t i, int64_t target) const;
+    // 最大的 x <= i 使 excess(x) <= target
+    size_t bwdSearch(size_t i, int64_t target) const;
+    size_t nextBlock(size_t b, int64_t target) const;
+    size_t prevBlock(size_t b, int64_t target) const;
+    bool scanForward(size_t &x, int64_t &e, size_t end, int64_t target) const;
+    bool scanBackward(size_t &x, int64_t &e, size_t begin, int64_t target) const;
+    unsigned byteAt(size_t x) const { return (bits[x / 64] >> (x % 64)) & 0xff; }
+};
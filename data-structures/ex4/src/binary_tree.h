@@ -2,150 +2,509 @@
 #define BINARY_TREE_H
 
 #include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
 #include <memory>
-#include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
 template <typename T>
 class BinaryTree {
 public:
+    // size/height/hash 描述以该结点为根的子树，hash 为其先序序列化（含虚结点）的哈希。
+    // 这些字段与 parent 由构建和 graft/prune/replace 维护，直接改写 left/right 会使其失效
     struct Node {
         T val;
+        uint32_t size = 1;
+        int height = 1;
         std::unique_ptr<Node> left;
         std::unique_ptr<Node> right;
-        explicit Node(const T &v) : val(v), left(nullptr), right(nullptr) {}
+        Node *parent = nullptr;
+        uint64_t hash;
+        explicit Node(const T &v) : val(v), left(nullptr), right(nullptr), hash(combineHash(v, NULL_HASH, NULL_HASH)) {}
     };
 
+    enum class Side { Left, Right };
+
+    static constexpr uint64_t NULL_HASH = 0x9E3779B97F4A7C15ull;
+
+    // 建立值索引时遇到重复值的处理：保留先序第一个（与 DFS 查找结果一致）、保留最后一个、或拒绝建立索引
+    enum class DuplicatePolicy { First, Last, Reject };
+
 private:
     std::unique_ptr<Node> root;
 
+    // 可选的值索引：entries 按先序存放每个结点及其父结点下标、层数；
+    // table 为线性探测的开放定址表，存 entries 下标。table 为空表示未建立索引。
+    static constexpr uint32_t NO_ENTRY = UINT32_MAX;
+    struct IndexEntry {
+        Node *node;
+        uint32_t parent;
+        uint32_t depth;
+    };
+    std::vector<IndexEntry> entries;
+    std::vector<uint32_t> table;
+    unsigned tableShift = 64;
+
+    explicit BinaryTree(std::unique_ptr<Node> root) : root(std::move(root)) {}
+
 public:
     BinaryTree() : root(nullptr) {}
-    ~BinaryTree() = default;
+    ~BinaryTree() { clear(); }
 
     BinaryTree(const BinaryTree &) = delete;
     BinaryTree &operator=(const BinaryTree &) = delete;
     BinaryTree(BinaryTree &&other) noexcept = default;
-    BinaryTree &operator=(BinaryTree &&other) noexcept = default;
+    BinaryTree &operator=(BinaryTree &&other) noexcept {
+        if (this != &other) {
+            clear();
+            root = std::move(other.root);
+            entries = std::move(other.entries);
+            table = std::move(other.table);
+            tableShift = other.tableShift;
+            other.dropIndex();
+        }
+        return *this;
+    }
 
-    void buildFromPreorder(const std::vector<T> &tokens, const T &nullValue) {
-        size_t idx = 0;
-        root = buildFromPreorderRec(tokens, idx, nullValue);
+    // 逐步右旋把左子树转到右侧，每个结点析构时两个孩子都已为空，不会递归析构
+    void clear() noexcept {
+        dropIndex();
+        std::unique_ptr<Node> cur = std::move(root);
+        while (cur) {
+            if (cur->left) {
+                std::unique_ptr<Node> l = std::move(cur->left);
+                cur->left = std::move(l->right);
+                l->right = std::move(cur);
+                cur = std::move(l);
+            } else {
+                cur = std::move(cur->right);
+            }
+        }
     }
 
-    std::vector<T> preorder() const {
-        std::vector<T> out;
-        preorderRec(root.get(), out);
-        return out;
+    // 增量先序构建器：逐个喂入记号，不需要整段记号序列。待填空位栈的大小就是空位计数，
+    // 空位用尽后仍有记号、或结束时仍有空位，都说明序列非法。
+    class PreorderBuilder {
+    public:
+        explicit PreorderBuilder(const T &nullValue) : nullValue(nullValue) { slots.push_back(&root); }
+        ~PreorderBuilder() { BinaryTree discard(std::move(root)); }
+
+        PreorderBuilder(const PreorderBuilder &) = delete;
+        PreorderBuilder &operator=(const PreorderBuilder &) = delete;
+
+        // 空位已用尽（多余记号）时返回 false
+        bool push(const T &token) {
+            if (slots.empty())
+                return false;
+            std::unique_ptr<Node> *slot = slots.back();
+            slots.pop_back();
+            if (token == nullValue)
+                return true;
+            *slot = std::make_unique<Node>(token);
+            slots.push_back(&(*slot)->right);
+            slots.push_back(&(*slot)->left);
+            return true;
+        }
+        bool complete() const { return slots.empty(); }
+        size_t openSlots() const { return slots.size(); }
+
+        // 取出已构建的部分（序列不完整时缺的子树为空），构建器随之清空
+        BinaryTree release() {
+            slots.clear();
+            BinaryTree tree(std::move(root));
+            tree.refreshAll();
+            return tree;
+        }
+
+    private:
+        T nullValue;
+        std::unique_ptr<Node> root;
+        std::vector<std::unique_ptr<Node> *> slots;
+    };
+
+    // 序列不完整时构建已读到的部分，多余记号忽略
+    void buildFromPreorder(const std::vector<T> &tokens, const T &nullValue) {
+        PreorderBuilder builder(nullValue);
+        for (const T &token : tokens)
+            if (!builder.push(token))
+                break;
+        *this = builder.release();
     }
-    std::vector<T> inorder() const {
-        std::vector<T> out;
-        inorderRec(root.get(), out);
-        return out;
+    // 构建后立即建立值索引；返回索引是否建立成功（仅 Reject 遇到重复值时失败，树本身照常构建）
+    bool buildFromPreorder(const std::vector<T> &tokens, const T &nullValue, DuplicatePolicy policy) {
+        buildFromPreorder(tokens, nullValue);
+        return buildIndex(policy);
     }
-    std::vector<T> postorder() const {
-        std::vector<T> out;
-        postorderRec(root.get(), out);
-        return out;
+
+    bool buildIndex(DuplicatePolicy policy = DuplicatePolicy::First) {
+        dropIndex();
+        if (!root)
+            return true;
+        // 先按先序收集结点，再按结点数一次定好表长（负载不超过 1/2），避免逐步扩容的重哈希
+        std::vector<std::pair<Node *, uint32_t>> stack{{root.get(), NO_ENTRY}};
+        while (!stack.empty()) {
+            auto [n, parent] = stack.back();
+            stack.pop_back();
+            uint32_t self = (uint32_t)entries.size();
+            entries.push_back({n, parent, parent == NO_ENTRY ? 1 : entries[parent].depth + 1});
+            if (n->right)
+                stack.push_back({n->right.get(), self});
+            if (n->left)
+                stack.push_back({n->left.get(), self});
+        }
+        table.assign(std::bit_ceil(entries.size() * 2), NO_ENTRY);
+        tableShift = 64 - std::countr_zero(table.size());
+        for (uint32_t e = 0; e < entries.size(); ++e) {
+            if (!indexInsert(e, policy)) {
+                dropIndex();
+                return false;
+            }
+        }
+        return true;
     }
-    std::vector<T> levelorder() const { return levelOrderRec(root.get()); }
+    void dropIndex() noexcept {
+        entries = {};
+        table = {};
+        tableShift = 64;
+    }
+    bool hasIndex() const { return !table.empty(); }
 
-    int height() const { return heightRec(root.get()); }
-    int nodeCount() const { return countRec(root.get()); }
+    enum class Order { Pre, In, Post, Level };
 
-    Node *find(const T &value) const { return findRec(root.get(), value); }
-    Node *findParent(const T &value) const { return findParentRec(root.get(), nullptr, value); }
+    // 惰性遍历：每次 ++ 只推进到下一个结点，不物化结果。
+    // 深度优先三种次序只保存 O(高度) 的栈，层次遍历保存 O(宽度) 的队列；
+    // 栈/队列容量增长到峰值后复用，逐元素不再分配。
+    // 迭代器指向所属 Traversal 的状态，与 istream_view 一样是单趟输入范围。
+    template <Order O>
+    class Traversal {
+    public:
+        class iterator {
+        public:
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
 
-    Node *getRoot() const { return root.get(); }
+            explicit iterator(Traversal *walk) : walk(walk) {}
 
-private:
-    std::unique_ptr<Node> buildFromPreorderRec(const std::vector<T> &tokens, size_t &idx, const T &nullValue) {
-        if (idx >= tokens.size())
-            return nullptr;
-        T cur = tokens[idx++];
-        if (cur == nullValue)
-            return nullptr;
-        auto node = std::make_unique<Node>(cur);
-        node->left = buildFromPreorderRec(tokens, idx, nullValue);
-        node->right = buildFromPreorderRec(tokens, idx, nullValue);
-        return node;
-    }
-
-    void preorderRec(Node *node, std::vector<T> &out) const {
-        if (!node)
-            return;
-        out.push_back(node->val);
-        preorderRec(node->left.get(), out);
-        preorderRec(node->right.get(), out);
-    }
+            const T &operator*() const { return walk->cur->val; }
+            const Node *node() const { return walk->cur; }
+            iterator &operator++() {
+                walk->advance();
+                return *this;
+            }
+            void operator++(int) { walk->advance(); }
+            bool operator==(std::default_sentinel_t) const { return walk->cur == nullptr; }
+
+        private:
+            Traversal *walk;
+        };
+
+        explicit Traversal(const Node *root) : root(root) {}
+
+        iterator begin() {
+            stack.clear();
+            queue.clear();
+            next = last = nullptr;
+            if constexpr (O == Order::Pre) {
+                if (root)
+                    stack.push_back(root);
+            } else if constexpr (O == Order::Level) {
+                if (root)
+                    queue.push_back(root);
+            } else {
+                next = root;
+            }
+            advance();
+            return iterator(this);
+        }
+        std::default_sentinel_t end() const { return {}; }
+
+    private:
+        const Node *root;
+        const Node *cur = nullptr;  // 当前产出的结点，nullptr 表示结束
+        const Node *next = nullptr; // 中序/后序：下一段要压栈的左链起点
+        const Node *last = nullptr; // 后序：上一个产出的结点
+        std::vector<const Node *> stack;
+        std::deque<const Node *> queue;
+
+        void advance() {
+            cur = nullptr;
+            if constexpr (O == Order::Pre) {
+                if (stack.empty())
+                    return;
+                cur = stack.back();
+                stack.pop_back();
+                if (cur->right)
+                    stack.push_back(cur->right.get());
+                if (cur->left)
+                    stack.push_back(cur->left.get());
+            } else if constexpr (O == Order::In) {
+                for (; next; next = next->left.get())
+                    stack.push_back(next);
+                if (stack.empty())
+                    return;
+                cur = stack.back();
+                stack.pop_back();
+                next = cur->right.get();
+            } else if constexpr (O == Order::Post) {
+                while (true) {
+                    for (; next; next = next->left.get())
+                        stack.push_back(next);
+                    if (stack.empty())
+                        return;
+                    const Node *top = stack.back();
+                    if (top->right && top->right.get() != last) {
+                        next = top->right.get();
+                    } else {
+                        cur = last = top;
+                        stack.pop_back();
+                        return;
+                    }
+                }
+            } else {
+                if (queue.empty())
+                    return;
+                cur = queue.front();
+                queue.pop_front();
+                if (cur->left)
+                    queue.push_back(cur->left.get());
+                if (cur->right)
+                    queue.push_back(cur->right.get());
+            }
+        }
+    };
+
+    Traversal<Order::Pre> preorderRange() const { return Traversal<Order::Pre>(root.get()); }
+    Traversal<Order::In> inorderRange() const { return Traversal<Order::In>(root.get()); }
+    Traversal<Order::Post> postorderRange() const { return Traversal<Order::Post>(root.get()); }
+    Traversal<Order::Level> levelorderRange() const { return Traversal<Order::Level>(root.get()); }
+
+    std::vector<T> preorder() const { return collect(preorderRange()); }
+    std::vector<T> inorder() const { return collect(inorderRange()); }
+    std::vector<T> postorder() const { return collect(postorderRange()); }
+    std::vector<T> levelorder() const { return collect(levelorderRange()); }
+
+    // 由根结点缓存的子树信息直接得到，O(1)
+    int height() const { return root ? root->height : 0; }
+    int nodeCount() const { return root ? (int)root->size : 0; }
+    uint64_t hash() const { return root ? root->hash : NULL_HASH; }
 
-    void inorderRec(Node *node, std::vector<T> &out) const {
+    // 把 sub 整棵接到 at 的 side 空位上，at 为 nullptr 表示接为根（要求本树为空）。
+    // 空位已被占用时返回 false，sub 保持不变。at 必须属于本树
+    bool graft(Node *at, Side side, BinaryTree &&sub) {
+        std::unique_ptr<Node> &slot = at ? (side == Side::Left ? at->left : at->right) : root;
+        if (slot)
+            return false;
+        dropIndex();
+        sub.dropIndex();
+        slot = std::move(sub.root);
+        if (slot)
+            slot->parent = at;
+        refreshUpward(at);
+        return true;
+    }
+    // 摘下以 node 为根的子树，作为一棵新树返回；node 为 nullptr 时返回空树
+    BinaryTree prune(Node *node) {
         if (!node)
-            return;
-        inorderRec(node->left.get(), out);
-        out.push_back(node->val);
-        inorderRec(node->right.get(), out);
+            return BinaryTree();
+        dropIndex();
+        Node *parent = node->parent;
+        BinaryTree out(std::move(slotOf(node)));
+        out.root->parent = nullptr;
+        refreshUpward(parent);
+        return out;
+    }
+    // 用 sub 替换以 node 为根的子树，返回换下的旧子树
+    BinaryTree replace(Node *node, BinaryTree &&sub) {
+        Node *parent = node->parent;
+        Side side = parent && parent->right.get() == node ? Side::Right : Side::Left;
+        BinaryTree old = prune(node);
+        graft(parent, side, std::move(sub));
+        return old;
     }
 
-    void postorderRec(Node *node, std::vector<T> &out) const {
-        if (!node)
-            return;
-        postorderRec(node->left.get(), out);
-        postorderRec(node->right.get(), out);
-        out.push_back(node->val);
+    // 有索引时 O(1) 查表，否则按先序返回第一个匹配的结点
+    Node *find(const T &value) const {
+        if (hasIndex()) {
+            uint32_t e = indexLookup(value);
+            return e == NO_ENTRY ? nullptr : entries[e].node;
+        }
+        std::vector<Node *> stack;
+        if (root)
+            stack.push_back(root.get());
+        while (!stack.empty()) {
+            Node *n = stack.back();
+            stack.pop_back();
+            if (n->val == value)
+                return n;
+            if (n->right)
+                stack.push_back(n->right.get());
+            if (n->left)
+                stack.push_back(n->left.get());
+        }
+        return nullptr;
+    }
+    Node *findParent(const T &value) const {
+        if (hasIndex()) {
+            uint32_t e = indexLookup(value);
+            return e == NO_ENTRY || entries[e].parent == NO_ENTRY ? nullptr : entries[entries[e].parent].node;
+        }
+        std::vector<std::pair<Node *, Node *>> stack;
+        if (root)
+            stack.push_back({root.get(), nullptr});
+        while (!stack.empty()) {
+            auto [n, parent] = stack.back();
+            stack.pop_back();
+            if (n->val == value)
+                return parent;
+            if (n->right)
+                stack.push_back({n->right.get(), n});
+            if (n->left)
+                stack.push_back({n->left.get(), n});
+        }
+        return nullptr;
     }
 
-    std::vector<T> levelOrderRec(Node *node) const {
-        std::vector<T> out;
-        if (!node)
-            return out;
-        std::queue<Node *> q;
-        q.push(node);
-        while (!q.empty()) {
-            Node *cur = q.front();
-            q.pop();
-            out.push_back(cur->val);
-            if (cur->left)
-                q.push(cur->left.get());
-            if (cur->right)
-                q.push(cur->right.get());
+    // 结点所在层数（根为第 1 层，与 height() 一致），不存在返回 0
+    int depth(const T &value) const {
+        if (hasIndex()) {
+            uint32_t e = indexLookup(value);
+            return e == NO_ENTRY ? 0 : (int)entries[e].depth;
         }
-        return out;
+        return (int)pathFromRoot(value).size();
+    }
+    // 从结点到根的路径（含两端），不存在返回空；有索引时沿父链接回溯，代价 O(深度)
+    std::vector<Node *> pathToRoot(const T &value) const {
+        if (!hasIndex()) {
+            std::vector<Node *> path = pathFromRoot(value);
+            std::reverse(path.begin(), path.end());
+            return path;
+        }
+        std::vector<Node *> path;
+        for (uint32_t e = indexLookup(value); e != NO_ENTRY; e = entries[e].parent)
+            path.push_back(entries[e].node);
+        return path;
     }
 
-    int heightRec(Node *node) const {
-        if (!node)
-            return 0;
-        return 1 + std::max(heightRec(node->left.get()), heightRec(node->right.get()));
+    Node *getRoot() const { return root.get(); }
+
+private:
+    static uint64_t mixHash(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ull;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+    static uint64_t combineHash(const T &v, uint64_t left, uint64_t right) {
+        return mixHash(mixHash(mixHash((uint64_t)std::hash<T>{}(v)) ^ left) + right);
+    }
+    static void refreshNode(Node *n) {
+        const Node *l = n->left.get(), *r = n->right.get();
+        n->size = 1 + (l ? l->size : 0) + (r ? r->size : 0);
+        n->height = 1 + std::max(l ? l->height : 0, r ? r->height : 0);
+        n->hash = combineHash(n->val, l ? l->hash : NULL_HASH, r ? r->hash : NULL_HASH);
+    }
+    // 修改点以上只有根路径上的结点需要更新，O(深度)
+    static void refreshUpward(Node *n) {
+        for (; n; n = n->parent)
+            refreshNode(n);
+    }
+    // 整棵树后序一遍，补齐 parent 与子树信息
+    void refreshAll() {
+        std::vector<Node *> stack;
+        Node *cur = root.get();
+        const Node *last = nullptr;
+        while (cur || !stack.empty()) {
+            while (cur) {
+                stack.push_back(cur);
+                cur = cur->left.get();
+            }
+            Node *top = stack.back();
+            if (top->right && top->right.get() != last) {
+                cur = top->right.get();
+                continue;
+            }
+            if (top->left)
+                top->left->parent = top;
+            if (top->right)
+                top->right->parent = top;
+            refreshNode(top);
+            last = top;
+            stack.pop_back();
+        }
+        if (root)
+            root->parent = nullptr;
+    }
+    std::unique_ptr<Node> &slotOf(Node *node) {
+        Node *p = node->parent;
+        return !p ? root : p->left.get() == node ? p->left : p->right;
     }
 
-    int countRec(Node *node) const {
-        if (!node)
-            return 0;
-        return 1 + countRec(node->left.get()) + countRec(node->right.get());
+    size_t hashSlot(const T &value) const {
+        return (uint64_t)std::hash<T>{}(value) * 0x9E3779B97F4A7C15ull >> tableShift;
+    }
+    uint32_t indexLookup(const T &value) const {
+        size_t mask = table.size() - 1;
+        for (size_t i = hashSlot(value);; i = (i + 1) & mask) {
+            uint32_t e = table[i];
+            if (e == NO_ENTRY || entries[e].node->val == value)
+                return e;
+        }
+    }
+    bool indexInsert(uint32_t self, DuplicatePolicy policy) {
+        const T &value = entries[self].node->val;
+        size_t mask = table.size() - 1;
+        for (size_t i = hashSlot(value);; i = (i + 1) & mask) {
+            uint32_t &e = table[i];
+            if (e == NO_ENTRY) {
+                e = self;
+                return true;
+            }
+            if (entries[e].node->val == value) {
+                if (policy == DuplicatePolicy::Reject)
+                    return false;
+                if (policy == DuplicatePolicy::Last)
+                    e = self;
+                return true;
+            }
+        }
     }
 
-    Node *findRec(Node *node, const T &value) const {
-        if (!node)
-            return nullptr;
-        if (node->val == value)
-            return node;
-        Node *l = findRec(node->left.get(), value);
-        if (l)
-            return l;
-        return findRec(node->right.get(), value);
+    // 无索引时的回退：后序式遍历中栈恰为根到当前结点的路径，按先序首次遇到匹配时返回
+    std::vector<Node *> pathFromRoot(const T &value) const {
+        std::vector<Node *> stack;
+        Node *cur = root.get();
+        const Node *last = nullptr;
+        while (cur || !stack.empty()) {
+            while (cur) {
+                stack.push_back(cur);
+                if (cur->val == value)
+                    return stack;
+                cur = cur->left.get();
+            }
+            Node *top = stack.back();
+            if (top->right && top->right.get() != last) {
+                cur = top->right.get();
+            } else {
+                last = top;
+                stack.pop_back();
+            }
+        }
+        return stack;
     }
 
-    Node *findParentRec(Node *node, Node *parent, const T &value) const {
-        if (!node)
-            return nullptr;
-        if (node->val == value)
-            return parent;
-        Node *l = findParentRec(node->left.get(), node, value);
-        if (l)
-            return l;
-        return findParentRec(node->right.get(), node, value);
+    template <typename Range>
+    static std::vector<T> collect(Range &&range) {
+        std::vector<T> out;
+        for (const T &v : range)
+            out.push_back(v);
+        return out;
     }
 };
 
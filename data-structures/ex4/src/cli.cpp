@@ -1,5 +1,7 @@
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
 #include <format>
-#include <functional>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -7,10 +9,15 @@
 #include "ascii_printer.h"
 #include "binary_tree.h"
 #include "cli.h"
-#include "utils.h"
+#include "preorder_stream.h"
+
+// 状态栏只画前 STATUS_COLUMNS 个中序列，大树用选项 4 翻页
+constexpr long STATUS_COLUMNS = 64;
 
 void printStatus(const BinaryTree<char> &tree) {
-    printAsciiBoxed(tree, 1);
+    AsciiViewport view;
+    view.colEnd = STATUS_COLUMNS;
+    printAsciiBoxed(tree, view, 1);
 
     auto root = tree.getRoot();
     if (!root) {
@@ -18,26 +25,57 @@ void printStatus(const BinaryTree<char> &tree) {
         return;
     }
 
-    std::string seq;
-    std::function<void(const BinaryTree<char>::Node *)> buildPreorder = [&](const BinaryTree<char>::Node *n) {
-        if (!n) {
-            seq.push_back('#');
-            return;
+    // 结点数、高度、哈希都由根结点缓存，O(1)；序列化要走整棵树，只在小树上输出
+    if (tree.nodeCount() <= STATUS_COLUMNS) {
+        std::string seq;
+        std::vector<const BinaryTree<char>::Node *> stack{root};
+        while (!stack.empty()) {
+            const BinaryTree<char>::Node *n = stack.back();
+            stack.pop_back();
+            if (!n) {
+                seq.push_back('#');
+                continue;
+            }
+            seq.push_back(n->val);
+            stack.push_back(n->right.get());
+            stack.push_back(n->left.get());
         }
-        seq.push_back(n->val);
-        buildPreorder(n->left.get());
-        buildPreorder(n->right.get());
-    };
-    buildPreorder(root);
+        std::cout << std::format("| toString: {}\n", seq);
+    }
+    std::cout << std::format("| nodeCount: {}, height: {}, hash: {:016x}\n\n", tree.nodeCount(), tree.height(),
+                             tree.hash());
+}
+
+// 边遍历边输出，不物化整条序列
+template <typename Range>
+void printSequence(const char *label, Range &&range) {
+    std::cout << label;
+    bool first = true;
+    for (char c : range) {
+        if (!first)
+            std::cout << ' ';
+        std::cout << c;
+        first = false;
+    }
+    std::cout << '\n';
+}
 
-    std::cout << std::format("| toString: {}\n", seq);
-    std::cout << std::format("| nodeCount: {}, height: {}\n\n", tree.nodeCount(), tree.height());
+// 空输入取默认值，非负整数以外返回 false
+bool parseCount(const std::string &s, long def, long &out) {
+    if (s.empty()) {
+        out = def;
+        return true;
+    }
+    auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+    return ec == std::errc() && end == s.data() + s.size() && out >= 0;
 }
 
 void printMenu() {
     std::cout << "1. 构建新二叉树\n";
     std::cout << "2. 显示遍历\n";
     std::cout << "3. 查找节点\n";
+    std::cout << "4. 分页查看树形\n";
+    std::cout << "5. 修改子树（嫁接/剪除/替换）\n";
     std::cout << "0. 退出\n";
     std::cout << "输入选项编号并回车：";
 }
@@ -61,24 +99,18 @@ void runCLI() {
             std::string s;
             if (!getline(std::cin, s))
                 break;
-            auto t = parseCharTokens(s);
-            if (isValidPreorder(t, '#')) {
-                BinaryTree<char> tmp;
-                tmp.buildFromPreorder(t, '#');
-                bt = std::move(tmp);
+            // 含空格时按单词切分，与 parseCharTokens 一致；非法时 bt 保持不变
+            if (buildFromChars(s, '#', bt, s.find(' ') != std::string::npos).ok) {
+                bt.buildIndex(BinaryTree<char>::DuplicatePolicy::First);
                 std::cout << "已构建。\n";
             } else {
                 std::cout << "输入序列非法，未构建。\n";
             }
         } else if (choice == "2") {
-            auto p = bt.preorder();
-            auto i = bt.inorder();
-            auto post = bt.postorder();
-            auto lvl = bt.levelorder();
-            std::cout << "先序: " << vecToStr(p) << '\n';
-            std::cout << "中序: " << vecToStr(i) << '\n';
-            std::cout << "后序: " << vecToStr(post) << '\n';
-            std::cout << "层次: " << vecToStr(lvl) << '\n';
+            printSequence("先序: ", bt.preorderRange());
+            printSequence("中序: ", bt.inorderRange());
+            printSequence("后序: ", bt.postorderRange());
+            printSequence("层次: ", bt.levelorderRange());
         } else if (choice == "3") {
             std::cout << "请输入要查找的字符：";
             std::string s;
@@ -100,6 +132,85 @@ void runCLI() {
             else
                 std::cout << ", 父节点 = null";
             std::cout << '\n';
+        } else if (choice == "4") {
+            AsciiViewport view;
+            std::string s;
+            std::cout << "子树根（回车为整棵树）：";
+            if (!getline(std::cin, s))
+                break;
+            if (!s.empty() && !(view.root = bt.find(s[0]))) {
+                std::cout << "节点不存在: '" << s[0] << "'\n";
+                continue;
+            }
+            long depth = 0, begin = 0, width = 0;
+            std::cout << "显示层数（回车不限）：";
+            if (!getline(std::cin, s))
+                break;
+            bool ok = parseCount(s, 0, depth);
+            std::cout << "起始中序列（回车为 0）：";
+            if (!getline(std::cin, s))
+                break;
+            ok = parseCount(s, 0, begin) && ok;
+            std::cout << "列数（回车为 " << STATUS_COLUMNS << "）：";
+            if (!getline(std::cin, s))
+                break;
+            ok = parseCount(s, STATUS_COLUMNS, width) && ok;
+            if (!ok) {
+                std::cout << "输入非法。\n";
+                continue;
+            }
+            view.maxDepth = (int)std::min<long>(depth, INT32_MAX);
+            view.colBegin = begin;
+            view.colEnd = begin + width;
+            std::cout << '\n';
+            printAsciiBoxed(bt, view, 1);
+        } else if (choice == "5") {
+            std::string op, s;
+            std::cout << "操作（g 嫁接 / p 剪除 / r 替换）：";
+            if (!getline(std::cin, op))
+                break;
+            if (op != "g" && op != "p" && op != "r") {
+                std::cout << "无效操作。\n";
+                continue;
+            }
+            std::cout << (op == "g" && !bt.getRoot() ? "目标结点（空树直接回车）：" : "目标结点：");
+            if (!getline(std::cin, s))
+                break;
+            BinaryTree<char>::Node *target = s.empty() ? nullptr : bt.find(s[0]);
+            if (!target && (op != "g" || bt.getRoot())) {
+                std::cout << "节点不存在: '" << (s.empty() ? ' ' : s[0]) << "'\n";
+                continue;
+            }
+            if (op == "p") {
+                BinaryTree<char> cut = bt.prune(target);
+                std::cout << "已剪除 " << cut.nodeCount() << " 个结点。\n";
+            } else {
+                auto side = BinaryTree<char>::Side::Left;
+                if (op == "g" && target) {
+                    std::cout << "接到左/右孩子（L/R）：";
+                    if (!getline(std::cin, s))
+                        break;
+                    if (s != "L" && s != "R" && s != "l" && s != "r") {
+                        std::cout << "无效选项。\n";
+                        continue;
+                    }
+                    side = s == "R" || s == "r" ? BinaryTree<char>::Side::Right : BinaryTree<char>::Side::Left;
+                }
+                std::cout << "请输入子树先序序列，虚结点用 # 指代：";
+                if (!getline(std::cin, s))
+                    break;
+                BinaryTree<char> sub;
+                if (!buildFromChars(s, '#', sub, s.find(' ') != std::string::npos).ok) {
+                    std::cout << "输入序列非法，未修改。\n";
+                } else if (op == "r") {
+                    bt.replace(target, std::move(sub));
+                    std::cout << "已替换。\n";
+                } else if (bt.graft(target, side, std::move(sub))) {
+                    std::cout << "已嫁接。\n";
+                } else {
+                    std::cout << "该位置已有子树，未修改。\n";
+                }
+            }
         } else if (choice == "0") {
             std::cout << "退出程序。\n";
             break;
@@ -0,0 +1,196 @@
+#ifndef FLAT_BINARY_TREE_H
+#define FLAT_BINARY_TREE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "binary_tree.h"
+
+// 紧凑存储的只读二叉树：结点按先序连续存放，孩子用 32 位下标表示。
+// 先序布局下左孩子总在 i + 1，先序遍历、查找、高度、层次遍历都退化为顺序扫描。
+template <typename T>
+class FlatBinaryTree {
+public:
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    // 代替 BinaryTree<T>::Node* 的轻量句柄，空句柄转换为 false
+    class Handle {
+    public:
+        Handle() = default;
+        Handle(const FlatBinaryTree *tree, uint32_t idx) : tree(tree), idx(idx) {}
+
+        explicit operator bool() const { return tree && idx != NIL; }
+        bool operator==(const Handle &other) const = default;
+
+        const T &val() const { return tree->vals[idx]; }
+        Handle left() const { return {tree, tree->lefts[idx]}; }
+        Handle right() const { return {tree, tree->rights[idx]}; }
+        uint32_t index() const { return idx; }
+
+    private:
+        const FlatBinaryTree *tree = nullptr;
+        uint32_t idx = NIL;
+    };
+
+private:
+    std::vector<T> vals;
+    std::vector<uint32_t> lefts;
+    std::vector<uint32_t> rights;
+
+public:
+    FlatBinaryTree() = default;
+
+    explicit FlatBinaryTree(const BinaryTree<T> &tree) {
+        using Node = typename BinaryTree<T>::Node;
+        struct Pending {
+            const Node *node;
+            uint32_t parent;
+            bool isRight;
+        };
+        std::vector<Pending> stack;
+        if (tree.getRoot())
+            stack.push_back({tree.getRoot(), NIL, false});
+        while (!stack.empty()) {
+            Pending p = stack.back();
+            stack.pop_back();
+            uint32_t i = append(p.node->val);
+            if (p.parent != NIL)
+                (p.isRight ? rights : lefts)[p.parent] = i;
+            if (p.node->right)
+                stack.push_back({p.node->right.get(), i, true});
+            if (p.node->left)
+                stack.push_back({p.node->left.get(), i, false});
+        }
+    }
+
+    void buildFromPreorder(const std::vector<T> &tokens, const T &nullValue) {
+        clear();
+        // 每个空位记录“父结点下标 + 是否右孩子”
+        std::vector<std::pair<uint32_t, bool>> slots{{NIL, false}};
+        size_t idx = 0;
+        while (!slots.empty() && idx < tokens.size()) {
+            auto [parent, isRight] = slots.back();
+            slots.pop_back();
+            const T &cur = tokens[idx++];
+            if (cur == nullValue)
+                continue;
+            uint32_t i = append(cur);
+            if (parent != NIL)
+                (isRight ? rights : lefts)[parent] = i;
+            slots.push_back({i, true});
+            slots.push_back({i, false});
+        }
+    }
+
+    void clear() {
+        vals.clear();
+        lefts.clear();
+        rights.clear();
+    }
+
+    size_t memoryBytes() const {
+        return vals.capacity() * sizeof(T) + (lefts.capacity() + rights.capacity()) * sizeof(uint32_t);
+    }
+
+    std::vector<T> preorder() const { return vals; }
+    std::vector<T> inorder() const {
+        std::vector<T> out;
+        out.reserve(vals.size());
+        std::vector<uint32_t> stack;
+        uint32_t cur = vals.empty() ? NIL : 0;
+        while (cur != NIL || !stack.empty()) {
+            while (cur != NIL) {
+                stack.push_back(cur);
+                cur = lefts[cur];
+            }
+            cur = stack.back();
+            stack.pop_back();
+            out.push_back(vals[cur]);
+            cur = rights[cur];
+        }
+        return out;
+    }
+    std::vector<T> postorder() const {
+        // 先序“根右左”的逆序即后序
+        std::vector<T> out;
+        out.reserve(vals.size());
+        std::vector<uint32_t> stack;
+        if (!vals.empty())
+            stack.push_back(0);
+        while (!stack.empty()) {
+            uint32_t i = stack.back();
+            stack.pop_back();
+            out.push_back(vals[i]);
+            if (lefts[i] != NIL)
+                stack.push_back(lefts[i]);
+            if (rights[i] != NIL)
+                stack.push_back(rights[i]);
+        }
+        std::reverse(out.begin(), out.end());
+        return out;
+    }
+    // 同一层内的左右次序与先序中的先后次序一致，因此按深度对先序做稳定计数排序即得层次序
+    std::vector<T> levelorder() const {
+        std::vector<uint32_t> depth = depths();
+        std::vector<size_t> start;
+        for (uint32_t d : depth) {
+            if (d >= start.size())
+                start.resize(d + 1, 0);
+            ++start[d];
+        }
+        size_t sum = 0;
+        for (size_t &s : start)
+            sum += std::exchange(s, sum);
+        std::vector<T> out(vals.size());
+        for (size_t i = 0; i < vals.size(); ++i)
+            out[start[depth[i]]++] = vals[i];
+        return out;
+    }
+
+    int height() const {
+        std::vector<uint32_t> depth = depths();
+        return depth.empty() ? 0 : int(*std::max_element(depth.begin(), depth.end())) + 1;
+    }
+    int nodeCount() const { return (int)vals.size(); }
+
+    Handle find(const T &value) const {
+        auto it = std::find(vals.begin(), vals.end(), value);
+        return it == vals.end() ? Handle() : Handle(this, uint32_t(it - vals.begin()));
+    }
+    Handle findParent(const T &value) const {
+        Handle n = find(value);
+        if (!n || n.index() == 0)
+            return {};
+        uint32_t i = n.index();
+        if (lefts[i - 1] == i)
+            return {this, i - 1};
+        auto it = std::find(rights.begin(), rights.begin() + i, i);
+        return {this, uint32_t(it - rights.begin())};
+    }
+
+    Handle getRoot() const { return vals.empty() ? Handle() : Handle(this, 0); }
+
+private:
+    uint32_t append(const T &v) {
+        vals.push_back(v);
+        lefts.push_back(NIL);
+        rights.push_back(NIL);
+        return uint32_t(vals.size() - 1);
+    }
+
+    // 父结点下标总小于孩子，一次正向扫描即可求出所有结点深度（根为 0）
+    std::vector<uint32_t> depths() const {
+        std::vector<uint32_t> depth(vals.size(), 0);
+        for (size_t i = 0; i < vals.size(); ++i) {
+            if (lefts[i] != NIL)
+                depth[lefts[i]] = depth[i] + 1;
+            if (rights[i] != NIL)
+                depth[rights[i]] = depth[i] + 1;
+        }
+        return depth;
+    }
+};
+
+#endif // FLAT_BINARY_TREE_H
@@ -0,0 +1,166 @@
+#ifndef PARALLEL_TREE_H
+#define PARALLEL_TREE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "binary_tree.h"
+#include "work_stealing_pool.h"
+
+// 自底向上的树折叠：fold(结点, 左子树结果, 右子树结果)，空子树取 empty。
+// 折叠结果只由树的形状决定，与子树在哪个线程、以什么次序完成无关，因此并行版本的结果是确定的
+// （浮点累加也逐位一致）。
+
+// 单线程折叠：后序遍历，结果栈里依次是已完成子树的值
+template <typename T, typename R, typename F>
+R foldSubtree(const typename BinaryTree<T>::Node *root, const R &empty, F &fold) {
+    using Node = typename BinaryTree<T>::Node;
+    if (!root)
+        return empty;
+    std::vector<R> results;
+    std::vector<const Node *> stack;
+    const Node *cur = root;
+    const Node *last = nullptr;
+    while (cur || !stack.empty()) {
+        while (cur) {
+            stack.push_back(cur);
+            cur = cur->left.get();
+        }
+        const Node *top = stack.back();
+        if (top->right && top->right.get() != last) {
+            cur = top->right.get();
+            continue;
+        }
+        R r = empty, l = empty;
+        if (top->right) {
+            r = std::move(results.back());
+            results.pop_back();
+        }
+        if (top->left) {
+            l = std::move(results.back());
+            results.pop_back();
+        }
+        results.push_back(fold(*top, l, r));
+        last = top;
+        stack.pop_back();
+    }
+    return std::move(results.back());
+}
+
+// 并行折叠。不足 cutoff 个结点的树直接单线程折叠；否则从根按层展开（最多 cutoff 个结点），
+// 直到边界上的子树数达到线程数的 16 倍，边界子树作为任务交给工作窃取线程池，
+// 最后在本线程按层逆序合并展开过的上层结点。斜链这类窄树展不开，退化为少量大任务。
+template <typename T, typename R, typename F>
+R parallelFold(const BinaryTree<T> &tree, WorkStealingPool &pool, const R &empty, F fold,
+               size_t cutoff = size_t(1) << 15) {
+    using Node = typename BinaryTree<T>::Node;
+    const Node *root = tree.getRoot();
+    if (!root)
+        return empty;
+
+    // 只数前 cutoff 个结点判断树的大小，小树不进线程池
+    {
+        std::vector<const Node *> stack{root};
+        size_t seen = 0;
+        while (!stack.empty() && seen <= cutoff) {
+            const Node *n = stack.back();
+            stack.pop_back();
+            ++seen;
+            if (n->right)
+                stack.push_back(n->right.get());
+            if (n->left)
+                stack.push_back(n->left.get());
+        }
+        if (seen <= cutoff || pool.size() == 1)
+            return foldSubtree<T>(root, empty, fold);
+    }
+
+    // 孩子引用：>= 0 为上层结点下标，< 0 为任务 -(k + 1)，NONE 为空子树
+    constexpr int64_t NONE = INT64_MIN;
+    struct Top {
+        const Node *node;
+        int64_t left = NONE, right = NONE;
+    };
+    struct Pending {
+        const Node *node;
+        size_t parent;
+        bool isRight;
+    };
+    std::vector<Top> top;
+    std::vector<const Node *> tasks;
+    std::deque<Pending> frontier{{root, SIZE_MAX, false}};
+    auto link = [&](const Pending &p, int64_t ref) {
+        if (p.parent != SIZE_MAX)
+            (p.isRight ? top[p.parent].right : top[p.parent].left) = ref;
+    };
+    size_t target = size_t(pool.size()) * 16;
+    while (!frontier.empty() && frontier.size() < target && top.size() < cutoff) {
+        Pending p = frontier.front();
+        frontier.pop_front();
+        link(p, (int64_t)top.size());
+        top.push_back({p.node});
+        if (p.node->left)
+            frontier.push_back({p.node->left.get(), top.size() - 1, false});
+        if (p.node->right)
+            frontier.push_back({p.node->right.get(), top.size() - 1, true});
+    }
+    for (const Pending &p : frontier) {
+        link(p, -(int64_t)tasks.size() - 1);
+        tasks.push_back(p.node);
+    }
+
+    // 包一层避免 R = bool 时落到 vector<bool> 的按位存储上产生数据竞争
+    struct Slot {
+        R value;
+    };
+    std::vector<Slot> taskResults(tasks.size(), Slot{empty});
+    pool.run(tasks.size(), [&](size_t i) { taskResults[i].value = foldSubtree<T>(tasks[i], empty, fold); });
+
+    std::vector<Slot> topResults(top.size(), Slot{empty});
+    auto resolve = [&](int64_t ref) -> const R & {
+        if (ref == NONE)
+            return empty;
+        return ref >= 0 ? topResults[ref].value : taskResults[-(ref + 1)].value;
+    };
+    for (size_t i = top.size(); i-- > 0;)
+        topResults[i].value = fold(*top[i].node, resolve(top[i].left), resolve(top[i].right));
+    return std::move(topResults[0].value);
+}
+
+// 按中序把 map(结点值) 用 combine 归约；combine 需满足结合律，identity 为其单位元
+template <typename T, typename R, typename Map, typename Combine>
+R parallelReduce(const BinaryTree<T> &tree, WorkStealingPool &pool, const R &identity, Map map, Combine combine,
+                 size_t cutoff = size_t(1) << 15) {
+    using Node = typename BinaryTree<T>::Node;
+    return parallelFold(
+        tree, pool, identity,
+        [&](const Node &n, const R &l, const R &r) { return combine(combine(l, map(n.val)), r); }, cutoff);
+}
+
+template <typename T>
+int parallelHeight(const BinaryTree<T> &tree, WorkStealingPool &pool) {
+    using Node = typename BinaryTree<T>::Node;
+    return parallelFold(tree, pool, 0, [](const Node &, int l, int r) { return 1 + std::max(l, r); });
+}
+
+template <typename T>
+size_t parallelNodeCount(const BinaryTree<T> &tree, WorkStealingPool &pool) {
+    using Node = typename BinaryTree<T>::Node;
+    return parallelFold(tree, pool, size_t(0), [](const Node &, size_t l, size_t r) { return 1 + l + r; });
+}
+
+// 与 BinaryTree::find 相同，返回先序第一个匹配的结点；并行版本不提前结束，总会走完整棵树
+template <typename T>
+const typename BinaryTree<T>::Node *parallelFind(const BinaryTree<T> &tree, WorkStealingPool &pool,
+                                                 const T &value) {
+    using Node = typename BinaryTree<T>::Node;
+    return parallelFold(tree, pool, static_cast<const Node *>(nullptr),
+                        [&](const Node &n, const Node *l, const Node *r) {
+                            return n.val == value ? &n : l ? l : r;
+                        });
+}
+
+#endif // PARALLEL_TREE_H
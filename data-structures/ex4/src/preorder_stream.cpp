@@ -0,0 +1,93 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "preorder_stream.h"
+
+namespace {
+
+bool isSpace(char c) { return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f'; }
+
+// 跨块保存“是否在单词中间”的状态，输入可以任意切块喂入
+class Scanner {
+public:
+    Scanner(char nullChar, bool words) : builder(nullChar), words(words) {}
+
+    bool feed(const char *p, size_t n) {
+        result.bytes += n;
+        for (const char *end = p + n; p != end; ++p) {
+            char c = *p;
+            if (isSpace(c)) {
+                inWord = false;
+                continue;
+            }
+            if (words && inWord)
+                continue;
+            inWord = true;
+            ++result.tokens;
+            if (!builder.push(c))
+                return false;
+        }
+        return true;
+    }
+
+    StreamBuildResult finish(BinaryTree<char> &tree) {
+        result.ok = builder.complete();
+        if (result.ok)
+            tree = builder.release();
+        return result;
+    }
+
+private:
+    BinaryTree<char>::PreorderBuilder builder;
+    StreamBuildResult result;
+    bool words;
+    bool inWord = false;
+};
+
+} // namespace
+
+StreamBuildResult buildFromChars(std::string_view text, char nullChar, BinaryTree<char> &tree, bool words) {
+    Scanner scanner(nullChar, words);
+    if (!scanner.feed(text.data(), text.size()))
+        return {};
+    return scanner.finish(tree);
+}
+
+StreamBuildResult buildFromStream(std::istream &in, char nullChar, BinaryTree<char> &tree, bool words) {
+    Scanner scanner(nullChar, words);
+    std::vector<char> buf(1 << 16);
+    while (in) {
+        in.read(buf.data(), (std::streamsize)buf.size());
+        if (!scanner.feed(buf.data(), (size_t)in.gcount()))
+            return {};
+    }
+    return scanner.finish(tree);
+}
+
+StreamBuildResult buildFromFile(const std::string &path, char nullChar, BinaryTree<char> &tree, bool words) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return {};
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return {};
+    }
+    size_t size = (size_t)st.st_size;
+    if (size == 0) {
+        close(fd);
+        return buildFromChars({}, nullChar, tree, words);
+    }
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return {};
+    madvise(data, size, MADV_SEQUENTIAL);
+    StreamBuildResult result = buildFromChars({static_cast<const char *>(data), size}, nullChar, tree, words);
+    munmap(data, size);
+    return result;
+}
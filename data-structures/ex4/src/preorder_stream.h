@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <string_view>
+
+#include "binary_tree.h"
+
+// 流式先序构建：边读边建树，同时用空位计数校验，不生成记号数组，只读一遍输入。
+// words 为 false 时每个非空白字符是一个记号；为 true 时取每个空白分隔单词的首字符
+// （与 parseCharTokens 在输入含空格时的切分一致）。
+// 失败时 tree 保持不变。
+struct StreamBuildResult {
+    bool ok = false;
+    size_t bytes = 0;
+    size_t tokens = 0;
+};
+
+StreamBuildResult buildFromChars(std::string_view text, char nullChar, BinaryTree<char> &tree, bool words = false);
+StreamBuildResult buildFromStream(std::istream &in, char nullChar, BinaryTree<char> &tree, bool words = false);
+// mmap 整个文件顺序扫描；打不开或映射失败也返回 ok = false
+StreamBuildResult buildFromFile(const std::string &path, char nullChar, BinaryTree<char> &tree, bool words = false);
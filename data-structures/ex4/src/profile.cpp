@@ -0,0 +1,539 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <malloc.h>
+
+#include "ascii_printer.h"
+#include "binary_tree.h"
+#include "flat_binary_tree.h"
+#include "parallel_tree.h"
+#include "preorder_stream.h"
+#include "succinct_binary_tree.h"
+#include "utils.h"
+
+// 先序序列（# 为虚结点）：n 个结点的左斜链
+std::vector<char> chainTokens(size_t n) {
+    std::vector<char> t;
+    t.reserve(2 * n + 1);
+    for (size_t i = 0; i < n; ++i)
+        t.push_back(char('a' + i % 26));
+    t.insert(t.end(), n + 1, '#');
+    return t;
+}
+
+// 先序序列：n 个结点、左右子树大小尽量均分的平衡树
+std::vector<char> balancedTokens(size_t n) {
+    std::vector<char> t;
+    t.reserve(2 * n + 1);
+    std::vector<size_t> stack{n};
+    size_t i = 0;
+    while (!stack.empty()) {
+        size_t sz = stack.back();
+        stack.pop_back();
+        if (sz == 0) {
+            t.push_back('#');
+            continue;
+        }
+        t.push_back(char('a' + i++ % 26));
+        size_t left = (sz - 1) / 2;
+        stack.push_back(sz - 1 - left);
+        stack.push_back(left);
+    }
+    return t;
+}
+
+// 先序序列：每个结点把剩余结点按 9:1 分给左右子树的偏斜树，高度约 log_{10/9} n
+std::vector<char> skewedTokens(size_t n) {
+    std::vector<char> t;
+    t.reserve(2 * n + 1);
+    std::vector<size_t> stack{n};
+    size_t i = 0;
+    while (!stack.empty()) {
+        size_t sz = stack.back();
+        stack.pop_back();
+        if (sz == 0) {
+            t.push_back('#');
+            continue;
+        }
+        t.push_back(char('a' + i++ % 26));
+        size_t left = (sz - 1) * 9 / 10;
+        stack.push_back(sz - 1 - left);
+        stack.push_back(left);
+    }
+    return t;
+}
+
+// 当前堆占用字节数（含分配器头部与 mmap 分配的大块）；与 RSS 不同，不受已释放内存复用的干扰
+size_t heapBytesInUse() {
+    struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+}
+
+template <typename F>
+double timeIt(F &&f) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    f();
+    auto t1 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(t1 - t0).count();
+}
+
+void profileShape(const std::string &shape, size_t n, std::ostream &out = std::cout) {
+    auto tokens = shape == "chain" ? chainTokens(n) : balancedTokens(n);
+    auto *tree = new BinaryTree<char>();
+    size_t sink = 0;
+    out << shape << " n=" << n << std::endl;
+    out << "  build: " << timeIt([&] { tree->buildFromPreorder(tokens, '#'); }) << "s" << std::endl;
+    tokens = {};
+    out << "  preorder: " << timeIt([&] { sink += tree->preorder().size(); }) << "s" << std::endl;
+    out << "  inorder: " << timeIt([&] { sink += tree->inorder().size(); }) << "s" << std::endl;
+    out << "  postorder: " << timeIt([&] { sink += tree->postorder().size(); }) << "s" << std::endl;
+    out << "  levelorder: " << timeIt([&] { sink += tree->levelorder().size(); }) << "s" << std::endl;
+    // height()/nodeCount() 读根上缓存的字段，这里计时的是同样结果的一遍后序折叠
+    auto heightFold = [](const BinaryTree<char>::Node &, int l, int r) { return 1 + std::max(l, r); };
+    auto countFold = [](const BinaryTree<char>::Node &, size_t l, size_t r) { return 1 + l + r; };
+    out << "  height: " << timeIt([&] { sink += foldSubtree<char>(tree->getRoot(), 0, heightFold); }) << "s"
+        << std::endl;
+    out << "  nodeCount: " << timeIt([&] { sink += foldSubtree<char>(tree->getRoot(), size_t(0), countFold); })
+        << "s" << std::endl;
+    out << "  find(miss): " << timeIt([&] { sink += tree->find('#') != nullptr; }) << "s" << std::endl;
+    out << "  findParent(miss): " << timeIt([&] { sink += tree->findParent('#') != nullptr; }) << "s" << std::endl;
+    out << "  destroy: " << timeIt([&] { delete tree; }) << "s (checksum " << sink << ")" << std::endl;
+}
+
+// 指针树与扁平先序布局：每结点内存与各遍历耗时对比
+void profileFlat(const std::string &shape, size_t n, std::ostream &out = std::cout) {
+    auto tokens = shape == "chain" ? chainTokens(n) : balancedTokens(n);
+    size_t sink = 0;
+    out << shape << " n=" << n << std::endl;
+
+    size_t heap0 = heapBytesInUse();
+    auto *tree = new BinaryTree<char>();
+    double tb = timeIt([&] { tree->buildFromPreorder(tokens, '#'); });
+    size_t ptrBytes = heapBytesInUse() - heap0;
+    FlatBinaryTree<char> flat;
+    double tf = timeIt([&] { flat.buildFromPreorder(tokens, '#'); });
+    tokens = {};
+    out << "  bytes/node: pointer " << double(ptrBytes) / n << ", flat " << double(flat.memoryBytes()) / n << std::endl;
+    out << "  build: pointer " << tb << "s, flat " << tf << "s" << std::endl;
+    out << "  preorder: pointer " << timeIt([&] { sink += tree->preorder().size(); }) << "s, flat "
+        << timeIt([&] { sink += flat.preorder().size(); }) << "s" << std::endl;
+    out << "  inorder: pointer " << timeIt([&] { sink += tree->inorder().size(); }) << "s, flat "
+        << timeIt([&] { sink += flat.inorder().size(); }) << "s" << std::endl;
+    out << "  levelorder: pointer " << timeIt([&] { sink += tree->levelorder().size(); }) << "s, flat "
+        << timeIt([&] { sink += flat.levelorder().size(); }) << "s" << std::endl;
+    // 指针树的 height() 只读根上缓存的字段，这里与 flat 一样计时一遍完整遍历
+    auto heightFold = [](const BinaryTree<char>::Node &, int l, int r) { return 1 + std::max(l, r); };
+    out << "  height: pointer " << timeIt([&] { sink += foldSubtree<char>(tree->getRoot(), 0, heightFold); })
+        << "s, flat " << timeIt([&] { sink += flat.height(); }) << "s" << std::endl;
+    out << "  find(miss): pointer " << timeIt([&] { sink += tree->find('#') != nullptr; }) << "s, flat "
+        << timeIt([&] { sink += bool(flat.find('#')); }) << "s (checksum " << sink << ")" << std::endl;
+    delete tree;
+}
+
+// 物化 vector 与惰性 range：完整遍历与只取前 100 个元素时的额外堆占用峰值和耗时
+template <typename Materialize, typename Lazy>
+void compareLazy(const char *name, Materialize &&materialize, Lazy &&lazy, size_t n, std::ostream &out) {
+    constexpr size_t prefix = 100;
+    size_t heap0 = heapBytesInUse(), vecPeak = 0, lazyPeak = 0, partialPeak = 0, sink = 0;
+    double tv = timeIt([&] {
+        auto v = materialize();
+        vecPeak = heapBytesInUse() - heap0;
+        sink += v.size();
+    });
+    // 每 64K 个元素采样一次堆占用，队列会随遍历分配/释放块，只看结束时会低估
+    double tl = timeIt([&] {
+        auto range = lazy();
+        size_t k = 0;
+        for (char c : range) {
+            sink += c;
+            if (++k % 65536 == 0)
+                lazyPeak = std::max(lazyPeak, heapBytesInUse() - heap0);
+        }
+        lazyPeak = std::max(lazyPeak, heapBytesInUse() - heap0);
+    });
+    double tvp = timeIt([&] {
+        auto v = materialize();
+        sink += std::min(v.size(), prefix);
+    });
+    double tlp = timeIt([&] {
+        auto range = lazy();
+        size_t k = 0;
+        for (auto it = range.begin(); it != range.end() && k < prefix; ++it, ++k)
+            sink += *it;
+        partialPeak = heapBytesInUse() - heap0;
+    });
+    out << "  " << name << ": full vector " << tv << "s/" << vecPeak << "B, lazy " << tl << "s/" << lazyPeak
+        << "B; first " << prefix << " of " << n << ": vector " << tvp << "s, lazy " << tlp << "s/" << partialPeak
+        << "B (checksum " << sink << ")" << std::endl;
+}
+
+void profileLazy(const std::string &shape, size_t n, std::ostream &out = std::cout) {
+    BinaryTree<char> tree;
+    tree.buildFromPreorder(shape == "chain" ? chainTokens(n) : balancedTokens(n), '#');
+    out << shape << " n=" << n << std::endl;
+    compareLazy("preorder", [&] { return tree.preorder(); }, [&] { return tree.preorderRange(); }, n, out);
+    compareLazy("inorder", [&] { return tree.inorder(); }, [&] { return tree.inorderRange(); }, n, out);
+    compareLazy("postorder", [&] { return tree.postorder(); }, [&] { return tree.postorderRange(); }, n, out);
+    compareLazy("levelorder", [&] { return tree.levelorder(); }, [&] { return tree.levelorderRange(); }, n, out);
+}
+
+// 值索引与 DFS 查找：int 结点值 1..n 互不相同，随机查询 find + findParent + depth
+void profileIndex(const std::string &shape, size_t n, std::ostream &out = std::cout) {
+    std::vector<int> tokens;
+    int next = 0;
+    for (char c : shape == "chain" ? chainTokens(n) : balancedTokens(n))
+        tokens.push_back(c == '#' ? 0 : ++next);
+    BinaryTree<int> plain, indexed;
+    double tp = timeIt([&] { plain.buildFromPreorder(tokens, 0); });
+    indexed.buildFromPreorder(tokens, 0);
+    tokens = {};
+    size_t heap0 = heapBytesInUse();
+    double tb = timeIt([&] { indexed.buildIndex(BinaryTree<int>::DuplicatePolicy::First); });
+    size_t indexBytes = heapBytesInUse() - heap0;
+
+    std::mt19937 rng(42);
+    auto query = [&](const BinaryTree<int> &tree, size_t q) {
+        size_t sink = 0;
+        for (size_t i = 0; i < q; ++i) {
+            int v = int(rng() % (n + n / 10)) + 1; // 约 9% 查询落空
+            sink += tree.find(v) != nullptr;
+            sink += tree.findParent(v) != nullptr;
+            sink += tree.depth(v);
+        }
+        return sink;
+    };
+    size_t dfsQueries = std::max<size_t>(10, 10'000'000 / n), indexQueries = 1'000'000, sink = 0;
+    double td = timeIt([&] { sink += query(plain, dfsQueries); });
+    double ti = timeIt([&] { sink += query(indexed, indexQueries); });
+    out << shape << " n=" << n << std::endl;
+    out << "  build: tree " << tp << "s, index " << tb << "s, " << double(indexBytes) / n << " bytes/node"
+        << std::endl;
+    out << "  queries/s: dfs " << dfsQueries / td << ", index " << indexQueries / ti << " (checksum " << sink << ")"
+        << std::endl;
+}
+
+// 并行聚合在 1…maxThreads 个线程上的扩展性；每个线程数都与单线程迭代版本核对结果
+void profileParallel(const std::string &shape, size_t n, unsigned maxThreads, std::ostream &out = std::cout) {
+    using Node = BinaryTree<char>::Node;
+    BinaryTree<char> tree;
+    tree.buildFromPreorder(shape == "chain"    ? chainTokens(n)
+                           : shape == "skewed" ? skewedTokens(n)
+                                               : balancedTokens(n),
+                           '#');
+    // 单线程基准是同样结果的一遍后序折叠；height()/nodeCount() 只读根上缓存的字段，不能作对照
+    auto heightFold = [](const Node &, int l, int r) { return 1 + std::max(l, r); };
+    auto countFold = [](const Node &, size_t l, size_t r) { return 1 + l + r; };
+    int h = 0;
+    size_t cnt = 0;
+    double th = timeIt([&] { h = foldSubtree<char>(tree.getRoot(), 0, heightFold); });
+    double tc = timeIt([&] { cnt = foldSubtree<char>(tree.getRoot(), size_t(0), countFold); });
+    bool cached = h == tree.height() && cnt == size_t(tree.nodeCount());
+    double tf = timeIt([&] { tree.find('#'); });
+    out << shape << " n=" << n << " height=" << h << std::endl;
+    out << "  sequential: height " << th << "s, nodeCount " << tc << "s, find(miss) " << tf << "s" << std::endl;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        WorkStealingPool pool(threads);
+        bool ok = cached;
+        double ph = timeIt([&] { ok &= parallelHeight(tree, pool) == h; });
+        double pc = timeIt([&] { ok &= parallelNodeCount(tree, pool) == cnt; });
+        double pf = timeIt([&] { ok &= parallelFind(tree, pool, '#') == nullptr; });
+        double sum = 0;
+        double ps = timeIt([&] {
+            sum = parallelFold(tree, pool, 0.0,
+                               [](const Node &nd, double l, double r) { return l + r + nd.val * 0.5; });
+        });
+        out << "  threads=" << threads << ": height " << ph << "s (x" << th / ph << "), nodeCount " << pc << "s (x"
+            << tc / pc << "), find " << pf << "s (x" << tf / pf << "), fold " << ps << "s, sum " << sum
+            << (ok ? "" : " MISMATCH") << std::endl;
+    }
+}
+
+// 流式构建与“整读 → parseCharTokens → isValidPreorder → buildFromPreorder”三遍流程的吞吐对比
+void profileStream(size_t n, std::ostream &out = std::cout) {
+    std::string path = "/tmp/ex4_profile_tokens.txt";
+    {
+        auto tokens = balancedTokens(n);
+        std::ofstream f(path, std::ios::binary);
+        f.write(tokens.data(), (std::streamsize)tokens.size());
+        f.put('\n');
+    }
+    out << "stream n=" << n << std::endl;
+    auto report = [&](const char *name, double t, size_t bytes, bool ok) {
+        out << "  " << name << ": " << t << "s, " << double(bytes) / t / 1e6 << " MB/s" << (ok ? "" : " FAILED")
+            << std::endl;
+    };
+    {
+        BinaryTree<char> tree;
+        StreamBuildResult r;
+        double t = timeIt([&] { r = buildFromFile(path, '#', tree); });
+        report("mmap", t, r.bytes, r.ok && tree.nodeCount() == (int)n);
+    }
+    {
+        BinaryTree<char> tree;
+        StreamBuildResult r;
+        double t = timeIt([&] {
+            std::ifstream f(path, std::ios::binary);
+            r = buildFromStream(f, '#', tree);
+        });
+        report("istream", t, r.bytes, r.ok && tree.nodeCount() == (int)n);
+    }
+    {
+        BinaryTree<char> tree;
+        size_t bytes = 0;
+        bool ok = false;
+        double t = timeIt([&] {
+            std::ifstream f(path, std::ios::binary);
+            std::string line;
+            std::getline(f, line);
+            bytes = line.size() + 1;
+            auto tokens = parseCharTokens(line);
+            ok = isValidPreorder(tokens, '#');
+            if (ok)
+                tree.buildFromPreorder(tokens, '#');
+        });
+        report("three-pass", t, bytes, ok && tree.nodeCount() == (int)n);
+    }
+    std::remove(path.c_str());
+}
+
+// 简洁编码与指针树：持久化后的载入耗时、内存，以及随机下行、父链回溯、子树大小的导航速度
+void profileSuccinct(const std::string &shape, size_t n, std::ostream &out = std::cout) {
+    std::string path = "/tmp/ex4_profile_tree.sbt";
+    auto tokens = shape == "chain" ? chainTokens(n) : balancedTokens(n);
+    BinaryTree<char> tree;
+    size_t heap0 = heapBytesInUse();
+    double rebuild = timeIt([&] { tree.buildFromPreorder(tokens, '#'); });
+    size_t pointerBytes = heapBytesInUse() - heap0;
+    tokens = {};
+    double encode = 0;
+    {
+        double t = timeIt([&] { SuccinctBinaryTree<char>(tree).save(path); });
+        encode = t;
+    }
+    SuccinctBinaryTree<char> sbt;
+    double load = timeIt([&] { sbt.load(path); });
+    out << shape << " n=" << n << std::endl;
+    out << "  bytes/node: pointer " << double(pointerBytes) / n << ", succinct " << double(sbt.memoryBytes()) / n
+        << std::endl;
+    out << "  load: rebuild pointer tree from preorder " << rebuild << "s, mmap " << load << "s (encode+save "
+        << encode << "s)" << std::endl;
+
+    // 随机下行：从根出发每步随机选左右，走到叶子；总步数约 10^7 时停下
+    std::mt19937 rng(7);
+    size_t sink = 0, steps = 0, walks = 0;
+    double tp = timeIt([&] {
+        for (; steps < 10'000'000; ++walks) {
+            const BinaryTree<char>::Node *v = tree.getRoot();
+            while (v) {
+                sink += v->val;
+                ++steps;
+                const BinaryTree<char>::Node *next = rng() & 1 ? v->left.get() : v->right.get();
+                v = next ? next : v->left ? v->left.get() : v->right.get();
+            }
+        }
+    });
+    rng.seed(7);
+    double ts = timeIt([&] {
+        for (size_t w = 0; w < walks; ++w) {
+            for (auto v = sbt.root(); v;) {
+                sink += sbt.val(v);
+                auto next = rng() & 1 ? sbt.left(v) : sbt.right(v);
+                v = next ? next : sbt.left(v) ? sbt.left(v) : sbt.right(v);
+            }
+        }
+    });
+    out << "  descend: pointer " << tp / steps * 1e9 << " ns/step, succinct " << ts / steps * 1e9 << " ns/step"
+        << std::endl;
+
+    // 随机结点的父链回溯（每个最多 1000 跳）与子树大小、层数；两种表示取同一批先序序号的结点。
+    // 指针树的子树大小读缓存字段，层数沿 parent 数出
+    constexpr size_t queries = 10'000;
+    std::vector<const BinaryTree<char>::Node *> byRank;
+    byRank.reserve(n);
+    for (std::vector<const BinaryTree<char>::Node *> stack{tree.getRoot()}; !stack.empty();) {
+        const BinaryTree<char>::Node *v = stack.back();
+        stack.pop_back();
+        if (!v)
+            continue;
+        byRank.push_back(v);
+        stack.push_back(v->right.get());
+        stack.push_back(v->left.get());
+    }
+    std::vector<SuccinctBinaryTree<char>::Node> picks;
+    std::vector<const BinaryTree<char>::Node *> pointerPicks;
+    for (size_t q = 0; q < queries; ++q) {
+        size_t rank = rng() % n;
+        picks.push_back(sbt.node(rank));
+        pointerPicks.push_back(byRank[rank]);
+    }
+    byRank = {};
+    size_t pointerHops = 0;
+    double tpParent = timeIt([&] {
+        for (auto v : pointerPicks)
+            for (size_t k = 0; v && k < 1000; v = v->parent, ++k)
+                ++pointerHops;
+    });
+    double tpSize = timeIt([&] {
+        for (auto v : pointerPicks) {
+            int depth = 0;
+            for (auto u = v; u; u = u->parent)
+                ++depth;
+            sink += v->size + depth;
+        }
+    });
+    out << "  pointer: parent " << tpParent / pointerHops * 1e9 << " ns/hop, subtreeSize+depth "
+        << tpSize / queries * 1e9 << " ns/query" << std::endl;
+    size_t hops = 0;
+    double tparent = timeIt([&] {
+        for (auto v : picks)
+            for (size_t k = 0; v && k < 1000; v = sbt.parent(v), ++k)
+                ++hops;
+    });
+    double tsize = timeIt([&] {
+        for (auto v : picks)
+            sink += sbt.subtreeSize(v) + sbt.depth(v);
+    });
+    out << "  succinct: parent " << tparent / hops * 1e9 << " ns/hop, subtreeSize+depth " << tsize / queries * 1e9
+        << " ns/query (checksum " << sink << ")" << std::endl;
+    std::remove(path.c_str());
+}
+
+// 视口渲染：不限层数取前 64 列、限 8 层取中间 64 列、深层子树限 6 层，报告耗时与帧大小
+void profileRender(const std::string &shape, size_t n, std::ostream &out = std::cout) {
+    BinaryTree<char> tree;
+    tree.buildFromPreorder(shape == "chain" ? chainTokens(n) : balancedTokens(n), '#');
+    out << shape << " n=" << n << " height=" << tree.height() << std::endl;
+    auto report = [&](const char *name, const AsciiViewport &view) {
+        std::string frame;
+        double t = timeIt([&] { frame = renderAscii(tree, view); });
+        out << "  " << name << ": " << t << "s, frame " << frame.size() << "B" << std::endl;
+    };
+    AsciiViewport view;
+    view.colEnd = 64;
+    report("first 64 columns", view);
+    view.maxDepth = 8;
+    view.colBegin = 96;
+    view.colEnd = 160;
+    report("depth 8, columns 96..160", view);
+    AsciiViewport sub;
+    sub.root = tree.getRoot();
+    for (int d = 0; d < 12 && (sub.root->left || sub.root->right); ++d)
+        sub.root = sub.root->left ? sub.root->left.get() : sub.root->right.get();
+    sub.maxDepth = 6;
+    report("subtree at depth 12, 6 levels", sub);
+}
+
+// 结构修改后读取状态：graft/prune 沿父链增量维护 O(高度) + 读取 O(1)，
+// 对比每次修改后整树重算高度、结点数与先序序列化哈希
+void profileMutate(const std::string &shape, size_t n, std::ostream &out = std::cout) {
+    using Node = BinaryTree<char>::Node;
+    using Side = BinaryTree<char>::Side;
+    BinaryTree<char> tree;
+    tree.buildFromPreorder(shape == "chain" ? chainTokens(n) : balancedTokens(n), '#');
+
+    // 一次修改：随机下行（每层以 1/4 概率停下）剪下一棵非根子树，再随机下行到一个空位接回去
+    std::mt19937 rng(11);
+    auto mutate = [&] {
+        Node *v = tree.getRoot();
+        do {
+            Node *next = rng() & 1 ? v->left.get() : v->right.get();
+            if (!next)
+                next = v->left ? v->left.get() : v->right.get();
+            if (!next)
+                break;
+            v = next;
+        } while (rng() % 4);
+        if (v == tree.getRoot())
+            return;
+        BinaryTree<char> cut = tree.prune(v);
+        Node *at = tree.getRoot();
+        for (;;) {
+            Side side = rng() & 1 ? Side::Left : Side::Right;
+            Node *next = side == Side::Left ? at->left.get() : at->right.get();
+            if (!next) {
+                tree.graft(at, side, std::move(cut));
+                return;
+            }
+            at = next;
+        }
+    };
+    auto recompute = [&] {
+        std::string seq;
+        int height = 0, count = 0;
+        std::vector<std::pair<const Node *, int>> stack{{tree.getRoot(), 1}};
+        while (!stack.empty()) {
+            auto [nd, depth] = stack.back();
+            stack.pop_back();
+            if (!nd) {
+                seq.push_back('#');
+                continue;
+            }
+            seq.push_back(nd->val);
+            height = std::max(height, depth);
+            ++count;
+            stack.push_back({nd->right.get(), depth + 1});
+            stack.push_back({nd->left.get(), depth + 1});
+        }
+        return std::hash<std::string>{}(seq) + height + count;
+    };
+
+    // 修改代价与树高成正比，按初始高度控制总步数
+    size_t ops = std::clamp<size_t>(10'000'000 / tree.height(), 10, 100'000);
+    size_t fullOps = std::clamp<size_t>(10'000'000 / n, 3, ops);
+    uint64_t sink = 0;
+    double ti = timeIt([&] {
+        for (size_t i = 0; i < ops; ++i) {
+            mutate();
+            sink += tree.hash() + tree.height() + tree.nodeCount();
+        }
+    });
+    double tf = timeIt([&] {
+        for (size_t i = 0; i < fullOps; ++i) {
+            mutate();
+            sink += recompute();
+        }
+    });
+    out << shape << " n=" << n << " height=" << tree.height() << std::endl;
+    out << "  update+status: incremental " << ti / ops * 1e6 << " us/op, recompute " << tf / fullOps * 1e6
+        << " us/op (x" << (tf / fullOps) / (ti / ops) << ", checksum " << sink << ")" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    std::string what = argc > 1 ? argv[1] : "all";
+    size_t maxN = argc > 2 ? std::stoull(argv[2]) : 10'000'000;
+    unsigned maxThreads = argc > 3 ? std::stoul(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+    for (size_t n = 1'000; n <= maxN; n *= 10) {
+        for (const char *shape : {"balanced", "chain"}) {
+            if (what == "iterative" || what == "all")
+                profileShape(shape, n);
+            if (what == "flat" || what == "all")
+                profileFlat(shape, n);
+            if (what == "lazy" || what == "all")
+                profileLazy(shape, n);
+            if (what == "index" || what == "all")
+                profileIndex(shape, n);
+        }
+        if (what == "render" || what == "all")
+            for (const char *shape : {"balanced", "chain"})
+                profileRender(shape, n);
+        if (what == "succinct" || what == "all")
+            for (const char *shape : {"balanced", "chain"})
+                profileSuccinct(shape, n);
+        if (what == "mutate" || what == "all")
+            for (const char *shape : {"balanced", "chain"})
+                profileMutate(shape, n);
+        if (what == "stream" || what == "all")
+            profileStream(n);
+        if (what == "parallel" || what == "all")
+            for (const char *shape : {"balanced", "skewed", "chain"})
+                profileParallel(shape, n, maxThreads);
+    }
+    return 0;
+}
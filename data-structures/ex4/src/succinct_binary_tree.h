@@ -0,0 +1,209 @@
+#ifndef SUCCINCT_BINARY_TREE_H
+#define SUCCINCT_BINARY_TREE_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "balanced_parens.h"
+#include "binary_tree.h"
+
+// 简洁编码的只读二叉树：结点按先序写成平衡括号（进入写 1、离开写 0，每结点 2 位），
+// 另用每结点 1 位记录“有左孩子”以区分唯一的孩子是左还是右，载荷按先序紧凑存放。
+// 导航直接在位串上做 rank/select 与超额搜索，不解压：
+// 孩子、父结点、子树大小 O(log n)，层数 O(1)。
+// 内存中的布局与文件完全相同，load() 只 mmap 并校验头部，不做任何重建。
+template <typename T>
+class SuccinctBinaryTree {
+    static_assert(std::is_trivially_copyable_v<T>, "payload is stored as raw bytes");
+
+public:
+    static constexpr size_t NONE = BalancedParens::NONE;
+
+    // 结点句柄：pos 为左括号位置，rank 为先序编号
+    struct Node {
+        size_t pos = NONE;
+        size_t rank = 0;
+        explicit operator bool() const { return pos != NONE; }
+        bool operator==(const Node &) const = default;
+    };
+
+    SuccinctBinaryTree() = default;
+    explicit SuccinctBinaryTree(const BinaryTree<T> &tree) {
+        using TreeNode = typename BinaryTree<T>::Node;
+        size_t count = (size_t)tree.nodeCount();
+        owned.assign(totalWords(count), 0);
+        owned[0] = MAGIC;
+        owned[1] = count;
+        owned[2] = sizeof(T);
+        attach(owned.data());
+
+        uint64_t *bits = owned.data() + HEADER_WORDS;
+        uint64_t *hasLeft = bits + bpWords(count) + BalancedParens::directoryWords(2 * count);
+        T *payload = reinterpret_cast<T *>(hasLeft + bitWords(count));
+        // 栈中第二项表示两个孩子都已入栈，再次弹出时写右括号
+        std::vector<std::pair<const TreeNode *, bool>> stack;
+        if (tree.getRoot())
+            stack.push_back({tree.getRoot(), false});
+        size_t pos = 0, rank = 0;
+        while (!stack.empty()) {
+            auto [n, expanded] = stack.back();
+            stack.pop_back();
+            if (expanded) {
+                ++pos;
+                continue;
+            }
+            bits[pos / 64] |= 1ull << (pos % 64);
+            ++pos;
+            if (n->left)
+                hasLeft[rank / 64] |= 1ull << (rank % 64);
+            std::memcpy(&payload[rank++], &n->val, sizeof(T));
+            stack.push_back({n, true});
+            if (n->right)
+                stack.push_back({n->right.get(), false});
+            if (n->left)
+                stack.push_back({n->left.get(), false});
+        }
+        BalancedParens::buildDirectory(bits, 2 * count, bits + bpWords(count));
+    }
+    ~SuccinctBinaryTree() { unmap(); }
+
+    SuccinctBinaryTree(const SuccinctBinaryTree &) = delete;
+    SuccinctBinaryTree &operator=(const SuccinctBinaryTree &) = delete;
+    SuccinctBinaryTree(SuccinctBinaryTree &&other) noexcept { *this = std::move(other); }
+    SuccinctBinaryTree &operator=(SuccinctBinaryTree &&other) noexcept {
+        if (this != &other) {
+            unmap();
+            owned = std::move(other.owned);
+            mapped = std::exchange(other.mapped, nullptr);
+            mappedBytes = std::exchange(other.mappedBytes, 0);
+            if (mapped)
+                attach(static_cast<const uint64_t *>(mapped));
+            else if (!owned.empty())
+                attach(owned.data());
+            else
+                detach();
+            other.owned.clear();
+            other.detach();
+        }
+        return *this;
+    }
+
+    bool save(const std::string &path) const {
+        FILE *f = std::fopen(path.c_str(), "wb");
+        if (!f)
+            return false;
+        size_t words = totalWords(n);
+        bool ok = std::fwrite(data, sizeof(uint64_t), words, f) == words;
+        return std::fclose(f) == 0 && ok;
+    }
+
+    // 只读映射文件；头部或长度不符时返回 false，原内容不变
+    bool load(const std::string &path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        void *p = MAP_FAILED;
+        size_t bytes = 0;
+        if (fstat(fd, &st) == 0 && (size_t)st.st_size >= HEADER_WORDS * sizeof(uint64_t)) {
+            bytes = (size_t)st.st_size;
+            p = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        if (p == MAP_FAILED)
+            return false;
+        const uint64_t *header = static_cast<const uint64_t *>(p);
+        if (header[0] != MAGIC || header[2] != sizeof(T) || header[1] > bytes ||
+            totalWords(header[1]) * sizeof(uint64_t) != bytes) {
+            munmap(p, bytes);
+            return false;
+        }
+        unmap();
+        owned.clear();
+        mapped = p;
+        mappedBytes = bytes;
+        attach(header);
+        return true;
+    }
+
+    size_t size() const { return n; }
+    size_t memoryBytes() const { return totalWords(n) * sizeof(uint64_t); }
+
+    Node root() const { return n ? Node{0, 0} : Node{}; }
+    // 先序第 rank 个结点
+    Node node(size_t rank) const { return rank < n ? Node{bp.select1(rank), rank} : Node{}; }
+
+    const T &val(Node v) const { return payload[v.rank]; }
+    bool hasLeft(Node v) const { return (leftBits[v.rank / 64] >> (v.rank % 64)) & 1; }
+
+    Node left(Node v) const { return hasLeft(v) ? Node{v.pos + 1, v.rank + 1} : Node{}; }
+    Node right(Node v) const {
+        size_t c = hasLeft(v) ? bp.findClose(v.pos + 1) + 1 : v.pos + 1;
+        if (!bp.get(c))
+            return {};
+        return {c, bp.rank1(c)};
+    }
+    Node parent(Node v) const {
+        size_t p = bp.enclose(v.pos);
+        return p == NONE ? Node{} : Node{p, bp.rank1(p)};
+    }
+    size_t subtreeSize(Node v) const { return (bp.findClose(v.pos) - v.pos + 1) / 2; }
+    // 根为第 1 层，与 BinaryTree::depth 一致
+    int depth(Node v) const { return (int)bp.excess(v.pos + 1); }
+
+private:
+    static constexpr uint64_t MAGIC = 0x3154425342345845ull; // "EX4BSBT1"
+    static constexpr size_t HEADER_WORDS = 3;
+
+    // 连续布局：头部 | 括号位串 | 括号目录 | 有左孩子位 | 载荷
+    std::vector<uint64_t> owned;
+    void *mapped = nullptr;
+    size_t mappedBytes = 0;
+    const uint64_t *data = nullptr;
+    size_t n = 0;
+    BalancedParens bp;
+    const uint64_t *leftBits = nullptr;
+    const T *payload = nullptr;
+
+    static size_t bitWords(size_t bits) { return (bits + 63) / 64; }
+    static size_t bpWords(size_t count) { return bitWords(2 * count); }
+    static size_t totalWords(size_t count) {
+        return HEADER_WORDS + bpWords(count) + BalancedParens::directoryWords(2 * count) + bitWords(count) +
+               (count * sizeof(T) + 7) / 8;
+    }
+
+    void attach(const uint64_t *base) {
+        data = base;
+        n = base[1];
+        const uint64_t *bits = base + HEADER_WORDS;
+        const uint64_t *directory = bits + bpWords(n);
+        bp = BalancedParens(bits, 2 * n, directory);
+        leftBits = directory + BalancedParens::directoryWords(2 * n);
+        payload = reinterpret_cast<const T *>(leftBits + bitWords(n));
+    }
+    void detach() {
+        data = nullptr;
+        n = 0;
+        bp = BalancedParens();
+        leftBits = nullptr;
+        payload = nullptr;
+    }
+    void unmap() {
+        if (mapped)
+            munmap(mapped, mappedBytes);
+        mapped = nullptr;
+        mappedBytes = 0;
+    }
+};
+
+#endif // SUCCINCT_BINARY_TREE_H
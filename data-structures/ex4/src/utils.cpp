@@ -1,4 +1,3 @@
-#include <functional>
 #include <sstream>
 
 #include "utils.h"
@@ -27,21 +26,17 @@ std::vector<char> parseCharTokens(const std::string &s) {
     return tokens;
 }
 
+// 空位计数：初始 1 个空位，实结点占 1 个并新增 2 个，虚结点占 1 个；
+// 空位提前用尽或最终不为 0 都说明序列非法
 bool isValidPreorder(const std::vector<char> &tokens, char nullChar) {
-    size_t n = tokens.size();
-    size_t idx = 0;
-    std::function<bool()> rec = [&]() -> bool {
-        if (idx >= n)
+    size_t slots = 1;
+    for (char c : tokens) {
+        if (slots == 0)
             return false;
-        char cur = tokens[idx++];
-        if (cur == nullChar)
-            return true;
-        if (!rec())
-            return false;
-        if (!rec())
-            return false;
-        return true;
-    };
-    bool ok = rec();
-    return ok && idx == n;
+        if (c == nullChar)
+            --slots;
+        else
+            ++slots;
+    }
+    return slots == 0;
 }
@@ -0,0 +1,95 @@
+#include <algorithm>
+
+#include "work_stealing_pool.h"
+
+WorkStealingPool::WorkStealingPool(unsigned threads) {
+    if (!threads)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < threads; ++i)
+        queues.push_back(std::make_unique<Queue>());
+    for (unsigned i = 1; i < threads; ++i)
+        workers.emplace_back([this, i] { workerLoop(i); });
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard lock(m);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &t : workers)
+        t.join();
+}
+
+void WorkStealingPool::runErased(size_t count, void (*fn)(void *, size_t), void *fnCtx) {
+    if (!count)
+        return;
+    if (workers.empty()) {
+        for (size_t i = 0; i < count; ++i)
+            fn(fnCtx, i);
+        return;
+    }
+    job = fn;
+    ctx = fnCtx;
+    remaining = count;
+    for (size_t i = 0; i < count; ++i) {
+        Queue &q = *queues[i % queues.size()];
+        std::lock_guard lock(q.m);
+        q.tasks.push_back(i);
+    }
+    {
+        std::lock_guard lock(m);
+        ++generation;
+    }
+    wake.notify_all();
+    while (tryRunOne(0)) {
+    }
+    std::unique_lock lock(m);
+    done.wait(lock, [&] { return remaining == 0; });
+}
+
+bool WorkStealingPool::tryRunOne(unsigned self) {
+    size_t task = 0;
+    bool found = false;
+    {
+        Queue &own = *queues[self];
+        std::lock_guard lock(own.m);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            found = true;
+        }
+    }
+    for (unsigned k = 1; !found && k < queues.size(); ++k) {
+        Queue &victim = *queues[(self + k) % queues.size()];
+        std::lock_guard lock(victim.m);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            found = true;
+        }
+    }
+    if (!found)
+        return false;
+    job(ctx, task);
+    if (remaining.fetch_sub(1) == 1) {
+        std::lock_guard lock(m);
+        done.notify_all();
+    }
+    return true;
+}
+
+void WorkStealingPool::workerLoop(unsigned self) {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock lock(m);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+        }
+        while (tryRunOne(self)) {
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// 工作窃取线程池：每个线程有自己的任务队列，从队尾取自己的任务，空闲时从其他队列队首窃取。
+// 调用 run() 的线程占用 0 号队列并参与执行，全部任务完成后才返回。
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    unsigned size() const { return (unsigned)queues.size(); }
+
+    // 执行 fn(0) … fn(count - 1)，任务按下标轮流分到各队列；fn 不应抛出异常
+    template <typename F>
+    void run(size_t count, F &&fn) {
+        using Fn = std::remove_reference_t<F>;
+        runErased(count, [](void *ctx, size_t i) { (*static_cast<Fn *>(ctx))(i); }, &fn);
+    }
+
+private:
+    struct Queue {
+        std::mutex m;
+        std::deque<size_t> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex m;
+    std::condition_variable wake, done;
+    void (*job)(void *, size_t) = nullptr;
+    void *ctx = nullptr;
+    std::atomic<size_t> remaining{0};
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    void runErased(size_t count, void (*fn)(void *, size_t), void *fnCtx);
+    bool tryRunOne(unsigned self);
+    void workerLoop(unsigned self);
+};
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <bit>
+#include <string>
+
+#include "ancestor_index.h"
+#include "parallel.h"
+
+template <typename T>
+AncestorIndex<T>::AncestorIndex(const Tree<T> &tree, unsigned threads)
+    : layout(tree, threads) {
+    build(threads);
+}
+
+template <typename T>
+AncestorIndex<T>::AncestorIndex(const CsrTree<T> &tree, unsigned threads)
+    : layout(tree, threads) {
+    build(threads);
+}
+
+template <typename T> void AncestorIndex<T>::build(unsigned threads) {
+    const std::vector<uint32_t> &parents = layout.parents();
+    size_t n = parents.size();
+    depths.resize(n);
+    for (size_t v = 1; v < n; ++v)
+        depths[v] = depths[parents[v]] + 1;
+    size_t blocks = (n + BLOCK - 1) / BLOCK;
+    blockMasks.resize(n);
+    sparse.assign(1, std::vector<uint32_t>(blocks));
+    parallelChunks(threads, blocks, [&](unsigned, size_t b, size_t e) {
+        for (size_t blk = b; blk < e; ++blk) {
+            size_t begin = blk * BLOCK, end = std::min(n, begin + BLOCK);
+            uint64_t mask = 0;
+            for (size_t i = begin; i < end; ++i) {
+                // 弹出不小于当前值的栈顶，它们不再是任何以后位置的后缀最小值
+                while (mask) {
+                    size_t top = begin + 63 - std::countl_zero(mask);
+                    if (parents[top] < parents[i])
+                        break;
+                    mask ^= 1ull << (top - begin);
+                }
+                mask |= 1ull << (i - begin);
+                blockMasks[i] = mask;
+            }
+            sparse[0][blk] = blockMin((uint32_t)begin, (uint32_t)(end - 1));
+        }
+    });
+    for (size_t k = 1; (size_t(1) << k) <= blocks; ++k) {
+        const std::vector<uint32_t> &prev = sparse[k - 1];
+        std::vector<uint32_t> level(blocks - (size_t(1) << k) + 1);
+        size_t half = size_t(1) << (k - 1);
+        parallelChunks(threads, level.size(), [&](unsigned, size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i)
+                level[i] = std::min(prev[i], prev[i + half]);
+        });
+        sparse.push_back(std::move(level));
+    }
+
+    // 按深度计数排序；按先根序扫描，组内自然有序
+    uint32_t maxDepth = 0;
+    for (uint32_t d : depths)
+        maxDepth = std::max(maxDepth, d);
+    levelStart.assign(n ? maxDepth + 2 : 1, 0);
+    for (uint32_t d : depths)
+        ++levelStart[d + 1];
+    for (size_t d = 1; d < levelStart.size(); ++d)
+        levelStart[d] += levelStart[d - 1];
+    levelNodes.resize(n);
+    std::vector<uint32_t> cursor(levelStart.begin(), levelStart.end() - 1);
+    for (uint32_t v = 0; v < n; ++v)
+        levelNodes[cursor[depths[v]]++] = v;
+}
+
+// 截至 r 的单调栈中第一个不早于 l 的位置即 [l, r] 的最小值位置
+template <typename T>
+uint32_t AncestorIndex<T>::blockMin(uint32_t l, uint32_t r) const {
+    uint64_t mask = blockMasks[r] & (~0ull << (l % BLOCK));
+    return layout.parents()[l / BLOCK * BLOCK + std::countr_zero(mask)];
+}
+
+template <typename T>
+uint32_t AncestorIndex<T>::rangeMin(uint32_t l, uint32_t r) const {
+    uint32_t bl = l / BLOCK, br = r / BLOCK;
+    if (bl == br)
+        return blockMin(l, r);
+    uint32_t m = std::min(blockMin(l, bl * BLOCK + BLOCK - 1),
+                          blockMin(br * BLOCK, r));
+    if (bl + 1 < br) {
+        uint32_t k = std::bit_width(br - bl - 1) - 1;
+        m = std::min({m, sparse[k][bl + 1], sparse[k][br - (1u << k)]});
+    }
+    return m;
+}
+
+template <typename T>
+uint32_t AncestorIndex<T>::lca(uint32_t u, uint32_t v) const {
+    if (u == v)
+        return u;
+    if (u > v)
+        std::swap(u, v);
+    return rangeMin(u + 1, v);
+}
+
+template <typename T>
+uint32_t AncestorIndex<T>::levelAncestor(uint32_t v, uint32_t k) const {
+    if (k > depths[v])
+        return NONE;
+    if (k <= 1)
+        return k ? layout.parent(v) : v;
+    uint32_t d = depths[v] - k;
+    auto first = levelNodes.begin() + levelStart[d];
+    auto last = levelNodes.begin() + levelStart[d + 1];
+    return *(std::upper_bound(first, last, v) - 1);
+}
+
+template <typename T>
+void AncestorIndex<T>::lca(std::span<const Query> queries,
+                           std::span<uint32_t> out, unsigned threads) const {
+    parallelChunks(threads, queries.size(), [&](unsigned, size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i)
+            out[i] = lca(queries[i].first, queries[i].second);
+    });
+}
+
+template <typename T>
+void AncestorIndex<T>::levelAncestor(std::span<const Query> queries,
+                                     std::span<uint32_t> out,
+                                     unsigned threads) const {
+    parallelChunks(threads, queries.size(), [&](unsigned, size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i)
+            out[i] = levelAncestor(queries[i].first, queries[i].second);
+    });
+}
+
+template <typename T> size_t AncestorIndex<T>::memoryBytes() const {
+    size_t bytes = layout.memoryBytes() +
+                   blockMasks.capacity() * sizeof(uint64_t) +
+                   (depths.capacity() + levelStart.capacity() +
+                    levelNodes.capacity()) *
+                       sizeof(uint32_t);
+    for (const auto &level : sparse)
+        bytes += level.capacity() * sizeof(uint32_t);
+    return bytes;
+}
+
+template class AncestorIndex<int>;
+template class AncestorIndex<long long>;
+template class AncestorIndex<std::string>;
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "preorder_layout.h"
+
+// 最近公共祖先与 k 级祖先查询，预处理一次后只读，可多线程并发查询。
+// 结点以先根序号 0 … n-1 标识（根为 0），深度从根的 0 起算。
+//
+// 先根序中 u < v 且 u != v 时，LCA(u, v) 是区间 (u, v] 内各结点父结点中先根序号最小者，
+// 因此对父结点数组做区间最小值即可：每 64 个位置一块，块内用单调栈位掩码 O(1) 求最小，
+// 块间用稀疏表，总内存 O(n)。
+// k 级祖先在按深度分组、组内按先根序排列的结点表中二分查找：
+// 它是目标深度上先根序号不超过 v 的最后一个结点，O(log 宽度)
+template <typename T> class AncestorIndex {
+  public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    using Query = std::pair<uint32_t, uint32_t>;
+
+    // threads 为 0 时取硬件线程数
+    explicit AncestorIndex(const Tree<T> &tree, unsigned threads = 0);
+    explicit AncestorIndex(const CsrTree<T> &tree, unsigned threads = 0);
+
+    size_t size() const { return layout.size(); }
+    // 值为 val 的结点的先根序号，不存在时为 NONE
+    uint32_t id(const T &val) const { return layout.id(val); }
+    const T &value(uint32_t v) const { return layout.value(v); }
+    uint32_t parent(uint32_t v) const { return layout.parent(v); }
+    uint32_t depth(uint32_t v) const { return depths[v]; }
+
+    uint32_t lca(uint32_t u, uint32_t v) const;
+    // v 的第 k 个祖先（k = 0 为 v 本身），k 超过深度时为 NONE
+    uint32_t levelAncestor(uint32_t v, uint32_t k) const;
+
+    // 批量查询：out[i] 为第 i 个查询的结果，查询按段分给 threads 个线程
+    void lca(std::span<const Query> queries, std::span<uint32_t> out,
+             unsigned threads = 0) const;
+    void levelAncestor(std::span<const Query> queries, std::span<uint32_t> out,
+                       unsigned threads = 0) const;
+
+    size_t memoryBytes() const;
+
+  private:
+    static constexpr uint32_t BLOCK = 64;
+
+    PreorderLayout<T> layout;
+    std::vector<uint32_t> depths;
+    // blockMasks[i]：块内截至 i 的单调栈，第 j 位表示位置 j 仍是某个后缀的最小值
+    std::vector<uint64_t> blockMasks;
+    // sparse[k][b]：第 b … b + 2^k - 1 块父结点序号的最小值
+    std::vector<std::vector<uint32_t>> sparse;
+    // 深度为 d 的结点是 levelNodes[levelStart[d] .. levelStart[d + 1])，先根序递增
+    std::vector<uint32_t> levelStart;
+    std::vector<uint32_t> levelNodes;
+
+    void build(unsigned threads);
+    // 父结点数组在 [l, r] 上的最小值，l 与 r 同块
+    uint32_t blockMin(uint32_t l, uint32_t r) const;
+    uint32_t rangeMin(uint32_t l, uint32_t r) const;
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// 先在内存缓冲中格式化，攒满一块再整块 fwrite，避免逐行写出的开销。
+// 任一次写入失败后 ok() 为 false，之后的输出照常缓冲但不再保证落盘
+class BufferedWriter {
+  public:
+    explicit BufferedWriter(std::FILE *out, size_t block = 1 << 20)
+        : out(out), block(block) {
+        buf.reserve(block + 256);
+    }
+    ~BufferedWriter() { flush(); }
+
+    BufferedWriter(const BufferedWriter &) = delete;
+    BufferedWriter &operator=(const BufferedWriter &) = delete;
+
+    void put(char c) {
+        buf.push_back(c);
+        spill();
+    }
+    void put(std::string_view s) {
+        buf.append(s);
+        spill();
+    }
+    // 整数直接转成十进制；字符串含分隔符、引号或换行时按 CSV 规则加引号；
+    // 其余类型经 operator<< 格式化
+    template <typename V> void value(const V &v) {
+        if constexpr (std::is_integral_v<V>) {
+            char tmp[24];
+            buf.append(tmp, std::to_chars(tmp, tmp + sizeof(tmp), v).ptr);
+        } else if constexpr (std::is_convertible_v<const V &,
+                                                   std::string_view>) {
+            std::string_view s = v;
+            if (s.find_first_of(",\"\n\t ") == std::string_view::npos) {
+                buf.append(s);
+            } else {
+                buf.push_back('"');
+                for (char c : s) {
+                    if (c == '"')
+                        buf.push_back('"');
+                    buf.push_back(c);
+                }
+                buf.push_back('"');
+            }
+        } else {
+            std::ostringstream os;
+            os << v;
+            buf.append(os.str());
+        }
+        spill();
+    }
+
+    // 写出缓冲中的全部内容并 fflush
+    bool flush() {
+        write();
+        good &= std::fflush(out) == 0;
+        return good;
+    }
+    bool ok() const { return good; }
+    // 已交给本对象的总字节数
+    uint64_t bytes() const { return written + buf.size(); }
+
+  private:
+    std::FILE *out;
+    size_t block;
+    std::string buf;
+    uint64_t written = 0;
+    bool good = true;
+
+    void spill() {
+        if (buf.size() >= block)
+            write();
+    }
+    void write() {
+        good &= std::fwrite(buf.data(), 1, buf.size(), out) == buf.size();
+        written += buf.size();
+        buf.clear();
+    }
+};
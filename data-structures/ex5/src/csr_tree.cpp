@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <type_traits>
+
+#include "csr_tree.h"
+#include "parallel.h"
+
+template <typename T>
+CsrTree<T>::CsrTree(const std::vector<std::pair<T, T>> &pairs,
+                    unsigned threads) {
+    build(pairs.data(), pairs.size(), threads);
+}
+
+template <typename T>
+CsrTree<T>::CsrTree(const std::pair<T, T> *pairs, size_t count,
+                    unsigned threads) {
+    build(pairs, count, threads);
+}
+
+// 编号为整数且 max - min 不超过序偶数的常数倍时用直接寻址表编号，否则排序去重后二分查找
+template <typename T>
+void CsrTree<T>::build(const std::pair<T, T> *pairs, size_t count,
+                       unsigned threads) {
+    threads = resolveThreads(threads);
+    if (count == 0)
+        return;
+    if constexpr (std::is_integral_v<T>) {
+        using U = std::make_unsigned_t<T>;
+        std::vector<T> lo(threads, pairs[0].first), hi(threads, pairs[0].first);
+        parallelChunks(threads, count, [&](unsigned t, size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i) {
+                lo[t] = std::min({lo[t], pairs[i].first, pairs[i].second});
+                hi[t] = std::max({hi[t], pairs[i].first, pairs[i].second});
+            }
+        });
+        T base = *std::min_element(lo.begin(), lo.end());
+        // 先比较 max - base 再加一：64 位编号跨满整个取值范围时 range 会回绕成 0
+        uint64_t span =
+            (uint64_t)(U)((U)*std::max_element(hi.begin(), hi.end()) -
+                          (U)base);
+        if (span < 4 * (uint64_t)count + 64) {
+            uint64_t range = span + 1;
+            denseBase = base;
+            denseIndex.assign(range, 0);
+            auto slot = [&](const T &v) -> uint32_t & {
+                return denseIndex[(U)((U)v - (U)base)];
+            };
+            parallelChunks(threads, count, [&](unsigned, size_t b, size_t e) {
+                for (size_t i = b; i < e; ++i) {
+                    std::atomic_ref<uint32_t>(slot(pairs[i].first))
+                        .store(1, std::memory_order_relaxed);
+                    std::atomic_ref<uint32_t>(slot(pairs[i].second))
+                        .store(1, std::memory_order_relaxed);
+                }
+            });
+            // 出现标记的前缀和即结点下标，分两遍并行完成
+            std::vector<uint32_t> partial(threads + 1, 0);
+            parallelChunks(threads, range, [&](unsigned t, size_t b, size_t e) {
+                uint32_t sum = 0;
+                for (size_t x = b; x < e; ++x)
+                    sum += denseIndex[x];
+                partial[t + 1] = sum;
+            });
+            for (unsigned t = 0; t < threads; ++t)
+                partial[t + 1] += partial[t];
+            values.resize(partial[threads]);
+            parallelChunks(threads, range, [&](unsigned t, size_t b, size_t e) {
+                uint32_t next = partial[t];
+                for (size_t x = b; x < e; ++x) {
+                    if (denseIndex[x]) {
+                        values[next] = (T)((U)base + (U)x);
+                        denseIndex[x] = next++;
+                    } else {
+                        denseIndex[x] = NONE;
+                    }
+                }
+            });
+            buildEdges(pairs, count, threads,
+                       [&](const T &v) { return slot(v); });
+            return;
+        }
+    }
+    values.resize(2 * count);
+    parallelChunks(threads, count, [&](unsigned, size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) {
+            values[2 * i] = pairs[i].first;
+            values[2 * i + 1] = pairs[i].second;
+        }
+    });
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    values.shrink_to_fit();
+    buildEdges(pairs, count, threads, [&](const T &v) {
+        return (uint32_t)(std::lower_bound(values.begin(), values.end(), v) -
+                          values.begin());
+    });
+}
+
+// 计数排序：按父结点并行计数并求前缀和得到 offsets，再并行散射序偶下标，
+// 最后在每个孩子区间内按序偶下标排序以恢复输入次序，并换成孩子的结点下标。
+// 连续同一父结点的序偶合并为一次原子操作，宽结点不会反复争用同一计数器
+template <typename T>
+template <typename IndexOf>
+void CsrTree<T>::buildEdges(const std::pair<T, T> *pairs, size_t count,
+                            unsigned threads, IndexOf indexOf) {
+    size_t n = values.size();
+    offsets.assign(n + 1, 0);
+    // 对 [b, e) 中父结点相同的每一段调用 fn(父结点, 段首, 段尾)
+    auto forEachRun = [&](size_t b, size_t e, auto &&fn) {
+        for (size_t i = b; i < e;) {
+            uint32_t p = indexOf(pairs[i].first);
+            size_t j = i + 1;
+            while (j < e && pairs[j].first == pairs[i].first)
+                ++j;
+            fn(p, i, j);
+            i = j;
+        }
+    };
+    parallelChunks(threads, count, [&](unsigned, size_t b, size_t e) {
+        forEachRun(b, e, [&](uint32_t p, size_t i, size_t j) {
+            std::atomic_ref<uint32_t>(offsets[p + 1])
+                .fetch_add((uint32_t)(j - i), std::memory_order_relaxed);
+        });
+    });
+
+    std::vector<uint32_t> partial(threads + 1, 0);
+    parallelChunks(threads, n, [&](unsigned t, size_t b, size_t e) {
+        for (size_t v = b + 1; v < e; ++v)
+            offsets[v + 1] += offsets[v];
+        partial[t + 1] = offsets[e];
+    });
+    for (unsigned t = 0; t < threads; ++t)
+        partial[t + 1] += partial[t];
+    parallelChunks(threads, n, [&](unsigned t, size_t b, size_t e) {
+        for (size_t v = b; v < e; ++v)
+            offsets[v + 1] += partial[t];
+    });
+
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    childIndex.resize(count);
+    parallelChunks(threads, count, [&](unsigned, size_t b, size_t e) {
+        forEachRun(b, e, [&](uint32_t p, size_t i, size_t j) {
+            uint32_t at = std::atomic_ref<uint32_t>(cursor[p]).fetch_add(
+                (uint32_t)(j - i), std::memory_order_relaxed);
+            for (; i < j; ++i)
+                childIndex[at++] = (uint32_t)i;
+        });
+    });
+    cursor = {};
+
+    parents.assign(n, NONE);
+    parallelChunks(threads, n, [&](unsigned, size_t b, size_t e) {
+        for (size_t v = b; v < e; ++v) {
+            auto first = childIndex.begin() + offsets[v];
+            auto last = childIndex.begin() + offsets[v + 1];
+            if (!std::is_sorted(first, last))
+                std::sort(first, last);
+            for (; first != last; ++first) {
+                uint32_t c = indexOf(pairs[*first].second);
+                *first = c;
+                parents[c] = (uint32_t)v;
+            }
+        }
+    });
+    std::vector<std::vector<uint32_t>> found(threads);
+    parallelChunks(threads, n, [&](unsigned t, size_t b, size_t e) {
+        for (size_t v = b; v < e; ++v)
+            if (parents[v] == NONE)
+                found[t].push_back((uint32_t)v);
+    });
+    for (const auto &part : found)
+        rootIndices.insert(rootIndices.end(), part.begin(), part.end());
+}
+
+template <typename T> uint32_t CsrTree<T>::find(const T &val) const {
+    if constexpr (std::is_integral_v<T>) {
+        using U = std::make_unsigned_t<T>;
+        if (!denseIndex.empty()) {
+            U x = (U)((U)val - (U)denseBase);
+            return x < denseIndex.size() ? denseIndex[x] : NONE;
+        }
+    }
+    auto it = std::lower_bound(values.begin(), values.end(), val);
+    return it != values.end() && *it == val ? (uint32_t)(it - values.begin())
+                                            : NONE;
+}
+
+// 所有根同时按层推进，层数即高度
+template <typename T> int CsrTree<T>::getHeight() const {
+    std::vector<uint32_t> level(rootIndices.begin(), rootIndices.end()), next;
+    int h = 0;
+    while (!level.empty()) {
+        ++h;
+        next.clear();
+        for (uint32_t v : level)
+            for (uint32_t c : children(v))
+                next.push_back(c);
+        level.swap(next);
+    }
+    return h;
+}
+
+template <typename T> size_t CsrTree<T>::memoryBytes() const {
+    return values.capacity() * sizeof(T) +
+           (offsets.capacity() + childIndex.capacity() + parents.capacity() +
+            denseIndex.capacity() + rootIndices.capacity()) *
+               sizeof(uint32_t);
+}
+
+template class CsrTree<int>;
+template class CsrTree<long long>;
+template class CsrTree<std::string>;
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+// 压缩稀疏行（CSR）布局的只读树：结点按编号升序编为 0 … n-1，
+// 结点 v 的孩子是 children[offsets[v] .. offsets[v + 1])，保持序偶在输入中的先后次序。
+// 没有父结点的结点都是根，输入可以是森林。
+// 构建为线性时间：按父结点并行计数、前缀和、并行散射，不为单个结点分配内存
+template <typename T> class CsrTree {
+  public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    CsrTree() = default;
+    // threads 为 0 时取硬件线程数
+    explicit CsrTree(const std::vector<std::pair<T, T>> &pairs,
+                     unsigned threads = 0);
+    CsrTree(const std::pair<T, T> *pairs, size_t count, unsigned threads = 0);
+
+    size_t size() const { return values.size(); }
+    // 第一个没有父结点的结点；空树为 NONE
+    uint32_t root() const { return rootIndices.empty() ? NONE : rootIndices[0]; }
+    // 各棵树的根，下标递增
+    std::span<const uint32_t> roots() const { return rootIndices; }
+    const T &value(uint32_t v) const { return values[v]; }
+    uint32_t parent(uint32_t v) const { return parents[v]; }
+    uint32_t degree(uint32_t v) const { return offsets[v + 1] - offsets[v]; }
+    std::span<const uint32_t> children(uint32_t v) const {
+        return {childIndex.data() + offsets[v], degree(v)};
+    }
+    // 编号为 val 的结点下标，不存在时为 NONE
+    uint32_t find(const T &val) const;
+
+    // 先根 / 后根遍历以 root 为根的树，visit(v) 依次收到结点下标；栈深 O(高度)
+    template <typename F> void preOrder(uint32_t root, F &&visit) const;
+    template <typename F> void postOrder(uint32_t root, F &&visit) const;
+    // 依次遍历森林中的每棵树
+    template <typename F> void preOrder(F &&visit) const {
+        for (uint32_t r : rootIndices)
+            preOrder(r, visit);
+    }
+    template <typename F> void postOrder(F &&visit) const {
+        for (uint32_t r : rootIndices)
+            postOrder(r, visit);
+    }
+    // 各棵树高度的最大值
+    int getHeight() const;
+
+    size_t memoryBytes() const;
+
+  private:
+    std::vector<T> values;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> childIndex;
+    std::vector<uint32_t> parents;
+    // 编号为整数且取值范围紧凑时，denseIndex[val - denseBase] 直接给出下标
+    std::vector<uint32_t> denseIndex;
+    T denseBase{};
+    std::vector<uint32_t> rootIndices;
+
+    void build(const std::pair<T, T> *pairs, size_t count, unsigned threads);
+    template <typename IndexOf>
+    void buildEdges(const std::pair<T, T> *pairs, size_t count,
+                    unsigned threads, IndexOf indexOf);
+};
+
+template <typename T>
+template <typename F>
+void CsrTree<T>::preOrder(uint32_t root, F &&visit) const {
+    // 栈中存 (结点, 下一个待访问孩子在 childIndex 中的位置)
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    visit(root);
+    stack.push_back({root, offsets[root]});
+    while (!stack.empty()) {
+        auto &[v, next] = stack.back();
+        if (next == offsets[v + 1]) {
+            stack.pop_back();
+            continue;
+        }
+        uint32_t c = childIndex[next++];
+        visit(c);
+        stack.push_back({c, offsets[c]});
+    }
+}
+
+template <typename T>
+template <typename F>
+void CsrTree<T>::postOrder(uint32_t root, F &&visit) const {
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    stack.push_back({root, offsets[root]});
+    while (!stack.empty()) {
+        auto &[v, next] = stack.back();
+        if (next == offsets[v + 1]) {
+            visit(v);
+            stack.pop_back();
+            continue;
+        }
+        uint32_t c = childIndex[next++];
+        stack.push_back({c, offsets[c]});
+    }
+}
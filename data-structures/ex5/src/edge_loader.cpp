@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "edge_loader.h"
+#include "parallel.h"
+
+namespace {
+
+// 只读映射整个文件，返回映射区与长度；空文件不映射
+std::pair<void *, size_t> mapFile(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("无法打开文件: " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("无法读取文件信息: " + path);
+    }
+    size_t bytes = (size_t)st.st_size;
+    void *map = nullptr;
+    if (bytes) {
+        map = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("无法映射文件: " + path);
+        }
+        // 构建会顺序扫几遍，先让内核预读
+        ::madvise(map, bytes, MADV_WILLNEED);
+    }
+    ::close(fd);
+    return {map, bytes};
+}
+
+// 不对齐地读一个 W 字节的编号
+template <typename W> W loadId(const char *p) {
+    W w;
+    std::memcpy(&w, p, sizeof(W));
+    return w;
+}
+
+std::string_view trim(std::string_view s) {
+    size_t b = s.find_first_not_of(" \t\r");
+    if (b == std::string_view::npos)
+        return {};
+    return s.substr(b, s.find_last_not_of(" \t\r") - b + 1);
+}
+
+// 空行与注释行不产生序偶
+bool isRecord(std::string_view line) {
+    line = trim(line);
+    return !line.empty() && line[0] != '#';
+}
+
+template <typename T> bool parseId(std::string_view s, T &out) {
+    s = trim(s);
+    if constexpr (std::is_integral_v<T>) {
+        auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+        return ec == std::errc() && end == s.data() + s.size();
+    } else {
+        out = T(s);
+        return !s.empty();
+    }
+}
+
+// 对 [b, e) 中的每一行调用 fn(行, 行首地址)，不含换行符
+template <typename F> void forEachLine(const char *b, const char *e, F &&fn) {
+    while (b < e) {
+        auto nl = (const char *)std::memchr(b, '\n', e - b);
+        const char *end = nl ? nl : e;
+        fn(std::string_view(b, end - b), b);
+        b = end + 1;
+    }
+}
+
+} // namespace
+
+template <typename T> MappedEdges<T>::MappedEdges(const std::string &path) {
+    static_assert(std::is_integral_v<T>, "二进制边表只支持整数编号");
+    static_assert(sizeof(std::pair<T, T>) == 2 * sizeof(T));
+    std::tie(map, mapBytes) = mapFile(path);
+    auto fail = [&](const std::string &what) {
+        if (map)
+            ::munmap(map, mapBytes);
+        throw std::runtime_error(what + ": " + path);
+    };
+    EdgeFileHeader h;
+    if (mapBytes < sizeof(h))
+        fail("边表文件过短");
+    std::memcpy(&h, map, sizeof(h));
+    if (std::memcmp(h.magic, EdgeFileHeader{}.magic, 4) != 0 ||
+        (h.idWidth != 4 && h.idWidth != 8))
+        fail("边表文件头不合法");
+    if (h.count > (mapBytes - sizeof(h)) / (2 * h.idWidth))
+        fail("边表文件长度不足");
+    count = (size_t)h.count;
+    const char *body = (const char *)map + sizeof(h);
+    if (h.idWidth == sizeof(T)) {
+        // 映射区按页对齐，文件头 16 字节，序偶按 T 对齐
+        first = reinterpret_cast<const std::pair<T, T> *>(body);
+        return;
+    }
+    converted.resize(count);
+    // 变窄时逐个检查取值范围，超出 T 的编号截断后可能撞上别的结点，整体拒绝
+    std::atomic<bool> overflow{false};
+    auto widen = [&]<typename W>(W) {
+        parallelChunks(0, count, [&](unsigned, size_t b, size_t e) {
+            bool bad = false;
+            for (size_t i = b; i < e; ++i) {
+                W p = loadId<W>(body + 2 * i * sizeof(W));
+                W c = loadId<W>(body + (2 * i + 1) * sizeof(W));
+                if constexpr (sizeof(W) > sizeof(T))
+                    bad |= !std::in_range<T>(p) || !std::in_range<T>(c);
+                converted[i] = {(T)p, (T)c};
+            }
+            if (bad)
+                overflow.store(true, std::memory_order_relaxed);
+        });
+    };
+    if (h.idWidth == 4)
+        widen(int32_t{});
+    else
+        widen(int64_t{});
+    if (overflow.load()) {
+        converted = {};
+        fail("边表中的编号超出 " + std::to_string(8 * sizeof(T)) +
+             " 位整数范围");
+    }
+    first = converted.data();
+    ::munmap(map, mapBytes);
+    map = nullptr;
+}
+
+uint32_t edgeFileIdWidth(const std::string &path) {
+    std::FILE *f = std::fopen(path.c_str(), "rb");
+    if (!f)
+        throw std::runtime_error("无法打开文件: " + path);
+    EdgeFileHeader h;
+    bool ok = std::fread(&h, sizeof(h), 1, f) == 1;
+    std::fclose(f);
+    if (!ok)
+        throw std::runtime_error("边表文件过短: " + path);
+    if (std::memcmp(h.magic, EdgeFileHeader{}.magic, 4) != 0 ||
+        (h.idWidth != 4 && h.idWidth != 8))
+        throw std::runtime_error("边表文件头不合法: " + path);
+    return h.idWidth;
+}
+
+template <typename T> MappedEdges<T>::~MappedEdges() {
+    if (map)
+        ::munmap(map, mapBytes);
+}
+
+template <typename T>
+void writeEdgeFile(const std::string &path,
+                   std::span<const std::pair<T, T>> edges) {
+    static_assert(std::is_integral_v<T> && (sizeof(T) == 4 || sizeof(T) == 8));
+    static_assert(sizeof(std::pair<T, T>) == 2 * sizeof(T));
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    if (!f)
+        throw std::runtime_error("无法写入文件: " + path);
+    EdgeFileHeader h;
+    h.idWidth = sizeof(T);
+    h.count = edges.size();
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+              std::fwrite(edges.data(), sizeof(edges[0]), edges.size(), f) ==
+                  edges.size();
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok)
+        throw std::runtime_error("写入边表失败: " + path);
+}
+
+template <typename T>
+std::vector<std::pair<T, T>> parseEdgeCsv(const std::string &path,
+                                          unsigned threads) {
+    auto [map, bytes] = mapFile(path);
+    const char *text = (const char *)map;
+    threads = (unsigned)std::max<size_t>(
+        1, std::min<size_t>(resolveThreads(threads), bytes / 4096 + 1));
+    // 第 t 段从 bytes * t / threads 之后的第一个行首开始
+    std::vector<const char *> cut(threads + 1, text + bytes);
+    cut[0] = text;
+    for (unsigned t = 1; t < threads; ++t) {
+        const char *p = text + bytes * t / threads;
+        auto nl = (const char *)std::memchr(p - 1, '\n', text + bytes - (p - 1));
+        cut[t] = std::max(cut[t - 1], nl ? nl + 1 : text + bytes);
+    }
+    std::vector<size_t> start(threads + 1, 0);
+    parallelChunks(threads, threads, [&](unsigned, size_t b, size_t e) {
+        for (size_t t = b; t < e; ++t)
+            forEachLine(cut[t], cut[t + 1], [&](std::string_view line, auto) {
+                start[t + 1] += isRecord(line);
+            });
+    });
+    for (unsigned t = 0; t < threads; ++t)
+        start[t + 1] += start[t];
+
+    std::vector<std::pair<T, T>> edges(start[threads]);
+    // 出错的行首地址，多个线程出错时取最靠前的
+    std::vector<const char *> bad(threads, nullptr);
+    parallelChunks(threads, threads, [&](unsigned, size_t b, size_t e) {
+        for (size_t t = b; t < e; ++t) {
+            size_t next = start[t];
+            forEachLine(cut[t], cut[t + 1], [&](std::string_view line,
+                                               const char *at) {
+                if (bad[t] || !isRecord(line))
+                    return;
+                size_t comma = line.find(',');
+                auto &[p, c] = edges[next++];
+                if (comma == std::string_view::npos ||
+                    !parseId(line.substr(0, comma), p) ||
+                    !parseId(line.substr(comma + 1), c))
+                    bad[t] = at;
+            });
+        }
+    });
+    for (const char *at : bad) {
+        if (!at)
+            continue;
+        size_t lineNo = 1 + std::count(text, at, '\n');
+        ::munmap(map, bytes);
+        throw std::runtime_error("边表第 " + std::to_string(lineNo) +
+                                 " 行格式错误: " + path);
+    }
+    if (map)
+        ::munmap(map, bytes);
+    return edges;
+}
+
+template class MappedEdges<int>;
+template class MappedEdges<long long>;
+template void writeEdgeFile(const std::string &,
+                            std::span<const std::pair<int, int>>);
+template void writeEdgeFile(const std::string &,
+                            std::span<const std::pair<long long, long long>>);
+template std::vector<std::pair<int, int>> parseEdgeCsv(const std::string &,
+                                                       unsigned);
+template std::vector<std::pair<long long, long long>>
+parseEdgeCsv(const std::string &, unsigned);
+template std::vector<std::pair<std::string, std::string>>
+parseEdgeCsv(const std::string &, unsigned);
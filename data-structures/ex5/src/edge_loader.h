@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 二进制边表文件：16 字节文件头后紧跟 count 个 (父, 子) 序偶，
+// 每个编号为 idWidth 字节（4 或 8）的有符号整数，按本机字节序存放
+struct EdgeFileHeader {
+    char magic[4] = {'E', 'X', '5', 'E'};
+    uint32_t idWidth = 0;
+    uint64_t count = 0;
+};
+
+// 把二进制边表整个 mmap 进来。文件中编号宽度与 T 相同时，序偶直接指向映射的页，
+// 不复制也不解析，可原样交给 Tree / CsrTree 的 (指针, 个数) 构造函数；
+// 宽度不同时才逐个转换到自有的数组中。
+// 文件打不开、文件头不合法、长度不足，或编号超出 T 的取值范围时抛出 std::runtime_error。
+// 只支持整数编号
+template <typename T> class MappedEdges {
+  public:
+    explicit MappedEdges(const std::string &path);
+    ~MappedEdges();
+    MappedEdges(const MappedEdges &) = delete;
+    MappedEdges &operator=(const MappedEdges &) = delete;
+
+    const std::pair<T, T> *data() const { return first; }
+    size_t size() const { return count; }
+    std::span<const std::pair<T, T>> edges() const { return {first, count}; }
+    // 是否直接指向映射的页
+    bool zeroCopy() const { return converted.empty() && count; }
+
+  private:
+    void *map = nullptr;
+    size_t mapBytes = 0;
+    const std::pair<T, T> *first = nullptr;
+    size_t count = 0;
+    std::vector<std::pair<T, T>> converted;
+};
+
+// 只读文件头，返回编号宽度（4 或 8），用来选择 MappedEdges 的 T；
+// 文件打不开或文件头不合法时抛出 std::runtime_error
+uint32_t edgeFileIdWidth(const std::string &path);
+
+// 写出二进制边表，编号宽度为 sizeof(T)；失败时抛出 std::runtime_error
+template <typename T>
+void writeEdgeFile(const std::string &path,
+                   std::span<const std::pair<T, T>> edges);
+
+// 并行解析文本边表：每行 "父,子"，字段两侧的空白忽略，空行和以 # 开头的行跳过。
+// 文件 mmap 后按行边界切成 threads 段，先并行数出各段的行数，
+// 再由各线程直接解析到结果数组中自己的区间，不产生中间数组。
+// threads 为 0 时取硬件线程数；格式错误时抛出 std::runtime_error 并给出行号
+template <typename T>
+std::vector<std::pair<T, T>> parseEdgeCsv(const std::string &path,
+                                          unsigned threads = 0);
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <string>
+
+#include "buffered_writer.h"
+#include "forest_stats.h"
+#include "parallel.h"
+
+namespace {
+
+// 每个线程一次领取的树的棵数，小树很多时减少争用
+constexpr size_t GRAIN = 64;
+
+template <typename T>
+void addNode(ComponentStats<T> &s, uint32_t depth, uint32_t degree) {
+    ++s.nodes;
+    s.height = std::max(s.height, depth);
+    s.maxDegree = std::max(s.maxDegree, degree);
+    if (degree == 0) {
+        ++s.leaves;
+        s.pathNodes += depth;
+    }
+}
+
+} // namespace
+
+// 树根的兄弟是下一棵树，只从它的长子往下走；栈中存 (结点, 层数)
+template <typename T>
+std::vector<ComponentStats<T>> componentStats(const Tree<T> &tree,
+                                              unsigned threads) {
+    std::vector<const TreeNode<T> *> roots = tree.getRoots();
+    std::vector<ComponentStats<T>> stats(roots.size());
+    parallelTasks(
+        threads, roots.size(),
+        [&](unsigned, size_t i) {
+            ComponentStats<T> &s = stats[i];
+            s.root = roots[i]->data;
+            std::vector<std::pair<const TreeNode<T> *, uint32_t>> stack{
+                {roots[i], 1}};
+            while (!stack.empty()) {
+                auto [node, depth] = stack.back();
+                stack.pop_back();
+                uint32_t degree = 0;
+                for (auto c = node->firstChild.get(); c;
+                     c = c->nextSibling.get()) {
+                    stack.push_back({c, depth + 1});
+                    ++degree;
+                }
+                addNode(s, depth, degree);
+            }
+        },
+        GRAIN);
+    return stats;
+}
+
+template <typename T>
+std::vector<ComponentStats<T>> componentStats(const CsrTree<T> &tree,
+                                              unsigned threads) {
+    std::span<const uint32_t> roots = tree.roots();
+    std::vector<ComponentStats<T>> stats(roots.size());
+    parallelTasks(
+        threads, roots.size(),
+        [&](unsigned, size_t i) {
+            ComponentStats<T> &s = stats[i];
+            s.root = tree.value(roots[i]);
+            std::vector<std::pair<uint32_t, uint32_t>> stack{{roots[i], 1}};
+            while (!stack.empty()) {
+                auto [v, depth] = stack.back();
+                stack.pop_back();
+                for (uint32_t c : tree.children(v))
+                    stack.push_back({c, depth + 1});
+                addNode(s, depth, tree.degree(v));
+            }
+        },
+        GRAIN);
+    return stats;
+}
+
+template <typename T>
+bool writeComponentStats(const std::vector<ComponentStats<T>> &stats,
+                         std::FILE *out) {
+    BufferedWriter w(out);
+    w.put("root,nodes,height,max_degree,leaves,path_nodes\n");
+    for (const auto &s : stats) {
+        w.value(s.root);
+        for (uint64_t x : {(uint64_t)s.nodes, (uint64_t)s.height,
+                           (uint64_t)s.maxDegree, (uint64_t)s.leaves,
+                           s.pathNodes}) {
+            w.put(',');
+            w.value(x);
+        }
+        w.put('\n');
+    }
+    return w.flush();
+}
+
+template std::vector<ComponentStats<int>>
+componentStats(const Tree<int> &, unsigned);
+template std::vector<ComponentStats<int>>
+componentStats(const CsrTree<int> &, unsigned);
+template bool writeComponentStats(const std::vector<ComponentStats<int>> &,
+                                  std::FILE *);
+template std::vector<ComponentStats<long long>>
+componentStats(const Tree<long long> &, unsigned);
+template std::vector<ComponentStats<long long>>
+componentStats(const CsrTree<long long> &, unsigned);
+template bool writeComponentStats(const std::vector<ComponentStats<long long>> &,
+                                  std::FILE *);
+template std::vector<ComponentStats<std::string>>
+componentStats(const Tree<std::string> &, unsigned);
+template std::vector<ComponentStats<std::string>>
+componentStats(const CsrTree<std::string> &, unsigned);
+template bool writeComponentStats(const std::vector<ComponentStats<std::string>> &,
+                                  std::FILE *);
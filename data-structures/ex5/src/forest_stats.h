@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "csr_tree.h"
+#include "tree.h"
+
+// 森林中一棵树的统计量
+template <typename T> struct ComponentStats {
+    T root{};
+    uint32_t nodes = 0;
+    uint32_t height = 0;    // 根到最深叶子路径上的结点数
+    uint32_t maxDegree = 0;
+    uint32_t leaves = 0;
+    uint64_t pathNodes = 0; // 根到各叶子路径的结点数之和，除以 leaves 即平均路径长
+};
+
+// 各棵树的统计量，次序与 Tree::getRoots() / CsrTree::roots() 一致。
+// 每棵树是一个任务，由 threads 个线程动态领取，大小悬殊的树也能摊匀；
+// 单棵树内部不再拆分。threads 为 0 时取硬件线程数
+template <typename T>
+std::vector<ComponentStats<T>> componentStats(const Tree<T> &tree,
+                                              unsigned threads = 0);
+template <typename T>
+std::vector<ComponentStats<T>> componentStats(const CsrTree<T> &tree,
+                                              unsigned threads = 0);
+
+// 写成 CSV（首行为列名，一棵树一行），经 BufferedWriter 整块写出；写入失败返回 false
+template <typename T>
+bool writeComponentStats(const std::vector<ComponentStats<T>> &stats,
+                         std::FILE *out);
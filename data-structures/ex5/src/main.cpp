@@ -1,14 +1,13 @@
 #include <iostream>
+#include <stdexcept>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "edge_loader.h"
 #include "tree.h"
 
-int main() {
-    std::vector<std::pair<int, int>> pairs = {{1, 2}, {1, 3}, {2, 4},
-                                              {2, 5}, {3, 6}, {3, 7}};
-    Tree<int> tree(pairs);
-
+template <typename T> void printTree(const Tree<T> &tree) {
     std::cout << "先根遍历: ";
     tree.preOrder();
 
@@ -22,6 +21,33 @@ int main() {
 
     std::cout << "根到每个叶子的路径: " << std::endl;
     tree.printPaths();
+}
+
+// 二进制边表按文件头中的编号宽度选 int 或 long long，不截断编号
+template <typename T> void printMapped(const std::string &path) {
+    MappedEdges<T> edges(path);
+    printTree(Tree<T>(edges.data(), edges.size()));
+}
 
+// 参数为边表文件时从中建树：.csv 为文本边表，其余按二进制边表 mmap；无参数时用内置示例
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::vector<std::pair<int, int>> pairs = {{1, 2}, {1, 3}, {2, 4},
+                                                  {2, 5}, {3, 6}, {3, 7}};
+        printTree(Tree<int>(pairs));
+        return 0;
+    }
+    std::string path = argv[1];
+    try {
+        if (path.ends_with(".csv"))
+            printTree(Tree<long long>(parseEdgeCsv<long long>(path)));
+        else if (edgeFileIdWidth(path) == 8)
+            printMapped<long long>(path);
+        else
+            printMapped<int>(path);
+    } catch (const std::runtime_error &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
     return 0;
 }
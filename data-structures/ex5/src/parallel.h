@@ -0,0 +1,43 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// threads 为 0 时取硬件线程数
+inline unsigned resolveThreads(unsigned threads) {
+    return threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// 把 [0, count) 均分为 threads 段，第 t 段在第 t 个线程上执行 fn(t, begin, end)，
+// 0 号段由调用线程执行；全部完成后返回
+template <typename F>
+void parallelChunks(unsigned threads, size_t count, F &&fn) {
+    threads = (unsigned)std::max<size_t>(
+        1, std::min<size_t>(resolveThreads(threads), count));
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t)
+        workers.emplace_back(
+            [&, t] { fn(t, count * t / threads, count * (t + 1) / threads); });
+    fn(0u, size_t(0), count / threads);
+    for (auto &w : workers)
+        w.join();
+}
+
+// 动态分派：各线程从共享计数器每次领取 grain 个下标，对每个下标 i 执行 fn(t, i)，
+// 适合耗时差别很大的任务；全部完成后返回
+template <typename F>
+void parallelTasks(unsigned threads, size_t count, F &&fn, size_t grain = 1) {
+    std::atomic<size_t> next{0};
+    parallelChunks(threads, count, [&](unsigned t, size_t, size_t) {
+        for (;;) {
+            size_t begin = next.fetch_add(grain, std::memory_order_relaxed);
+            if (begin >= count)
+                return;
+            for (size_t i = begin; i < std::min(count, begin + grain); ++i)
+                fn(t, i);
+        }
+    });
+}
@@ -0,0 +1,58 @@
+#include <string>
+
+#include "buffered_writer.h"
+#include "path_stream.h"
+
+template <typename T> PathSummary summarizePaths(const Tree<T> &tree) {
+    PathSummary s;
+    if (!tree.getRoot())
+        return s;
+    std::vector<std::pair<const TreeNode<T> *, size_t>> stack{
+        {tree.getRoot(), 1}};
+    while (!stack.empty()) {
+        auto [node, len] = stack.back();
+        stack.pop_back();
+        if (node->nextSibling)
+            stack.push_back({node->nextSibling.get(), len});
+        if (node->firstChild) {
+            stack.push_back({node->firstChild.get(), len + 1});
+            continue;
+        }
+        if (s.lengthCounts.size() <= len)
+            s.lengthCounts.resize(len + 1, 0);
+        ++s.lengthCounts[len];
+        ++s.paths;
+        s.pathNodes += len;
+    }
+    return s;
+}
+
+template <typename T>
+bool writePathDeltas(const Tree<T> &tree, std::FILE *out, uint64_t *bytes) {
+    BufferedWriter w(out);
+    PathDeltas<T> walk(tree);
+    for (auto it = walk.begin(); it != std::default_sentinel; ++it) {
+        auto [shared, suffix, leaf] = *it;
+        w.value((uint64_t)shared);
+        w.put('\t');
+        for (size_t i = 0; i < suffix.size(); ++i) {
+            if (i)
+                w.put(' ');
+            w.value(suffix[i]);
+        }
+        w.put('\n');
+    }
+    bool ok = w.flush();
+    if (bytes)
+        *bytes = w.bytes();
+    return ok;
+}
+
+template PathSummary summarizePaths(const Tree<int> &);
+template PathSummary summarizePaths(const Tree<long long> &);
+template PathSummary summarizePaths(const Tree<std::string> &);
+template bool writePathDeltas(const Tree<int> &, std::FILE *, uint64_t *);
+template bool writePathDeltas(const Tree<long long> &, std::FILE *,
+                              uint64_t *);
+template bool writePathDeltas(const Tree<std::string> &, std::FILE *,
+                              uint64_t *);
@@ -0,0 +1,134 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "tree.h"
+
+// 按先根次序流式产出根到叶子的路径。相邻两条路径共享从根开始的一段前缀，
+// 每条只给出与上一条共享的结点数和其后的后缀，所有路径的后缀总长为 O(结点数)，
+// 而完整路径的总长可达 O(结点数²)。森林中换树时共享长度为 0。
+// 单趟输入范围，迭代器指向所属 PathDeltas 的状态
+template <typename T> class PathDeltas {
+  public:
+    struct Delta {
+        size_t shared;              // 与上一条路径共享的前缀结点数
+        std::span<const T> suffix;  // 其余结点，至下一次 ++ 前有效
+        const TreeNode<T> *leaf;
+    };
+
+    class iterator {
+      public:
+        using value_type = Delta;
+        using difference_type = std::ptrdiff_t;
+
+        explicit iterator(PathDeltas *walk) : walk(walk) {}
+
+        Delta operator*() const {
+            return {walk->shared,
+                    std::span<const T>(walk->path).subspan(walk->shared),
+                    walk->leaf};
+        }
+        // 当前路径整条，至下一次 ++ 前有效
+        std::span<const T> path() const { return walk->path; }
+        iterator &operator++() {
+            walk->advance();
+            return *this;
+        }
+        void operator++(int) { walk->advance(); }
+        bool operator==(std::default_sentinel_t) const {
+            return walk->leaf == nullptr;
+        }
+
+      private:
+        PathDeltas *walk;
+    };
+
+    explicit PathDeltas(const Tree<T> &tree) : root(tree.getRoot()) {}
+
+    iterator begin() {
+        stack.clear();
+        path.clear();
+        if (root)
+            stack.push_back({root, 0});
+        advance();
+        return iterator(this);
+    }
+    std::default_sentinel_t end() const { return {}; }
+
+  private:
+    const TreeNode<T> *root;
+    const TreeNode<T> *leaf = nullptr; // 当前路径的叶子，nullptr 表示结束
+    size_t shared = 0;
+    // 栈中存 (结点, 它在路径中的下标)，与 Tree::forEachPath 相同
+    std::vector<std::pair<const TreeNode<T> *, size_t>> stack;
+    std::vector<T> path;
+
+    // 从上一条路径截断时记下截到的最短长度，即共享前缀
+    void advance() {
+        leaf = nullptr;
+        shared = path.size();
+        while (!stack.empty()) {
+            auto [node, depth] = stack.back();
+            stack.pop_back();
+            if (depth < path.size()) {
+                path.erase(path.begin() + depth, path.end());
+                shared = std::min(shared, depth);
+            }
+            path.push_back(node->data);
+            if (node->nextSibling)
+                stack.push_back({node->nextSibling.get(), depth});
+            if (node->firstChild) {
+                stack.push_back({node->firstChild.get(), depth + 1});
+            } else {
+                leaf = node;
+                return;
+            }
+        }
+    }
+};
+
+// 不生成路径的聚合，只在栈上保存每个结点的层数
+struct PathSummary {
+    uint64_t paths = 0;     // 根到叶子的路径条数（即叶子数）
+    uint64_t pathNodes = 0; // 各路径结点数之和，即完整输出的规模
+    // lengthCounts[k]：恰含 k 个结点的路径条数，下标 0 恒为 0
+    std::vector<uint64_t> lengthCounts;
+};
+
+template <typename T> PathSummary summarizePaths(const Tree<T> &tree);
+
+// 对每个叶子按先根次序 visit(const TreeNode<T> &叶子, S 根到它的结点值之和)；
+// 栈中只存祖先的部分和，S 默认为 T
+template <typename S = void, typename T, typename F>
+void forEachPathSum(const Tree<T> &tree, F &&visit) {
+    using Sum = std::conditional_t<std::is_void_v<S>, T, S>;
+    if (!tree.getRoot())
+        return;
+    // 栈中存 (结点, 它的父结点处的部分和)；兄弟与它共享父结点的部分和
+    std::vector<std::pair<const TreeNode<T> *, Sum>> stack{
+        {tree.getRoot(), Sum{}}};
+    while (!stack.empty()) {
+        auto [node, above] = stack.back();
+        stack.pop_back();
+        Sum sum = above + (Sum)node->data;
+        if (node->nextSibling)
+            stack.push_back({node->nextSibling.get(), above});
+        if (node->firstChild)
+            stack.push_back({node->firstChild.get(), sum});
+        else
+            visit(*node, sum);
+    }
+}
+
+// 前缀压缩的文本格式：每条路径一行，先写共享前缀的结点数，再写制表符和空格分隔的后缀。
+// 经 BufferedWriter 整块写出；写入失败返回 false。bytes 非空时写入输出的字节数
+template <typename T>
+bool writePathDeltas(const Tree<T> &tree, std::FILE *out,
+                     uint64_t *bytes = nullptr);
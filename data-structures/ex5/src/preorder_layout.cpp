@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <string>
+
+#include "parallel.h"
+#include "preorder_layout.h"
+
+// 栈中存 (结点, 父结点序号)，兄弟后压、长子先出；第一棵树的根的兄弟是别的树，不压栈
+template <typename T>
+PreorderLayout<T>::PreorderLayout(const Tree<T> &tree, unsigned threads) {
+    std::vector<std::pair<const TreeNode<T> *, uint32_t>> stack;
+    if (tree.getRoot())
+        stack.push_back({tree.getRoot(), NONE});
+    while (!stack.empty()) {
+        auto [node, parent] = stack.back();
+        stack.pop_back();
+        uint32_t id = (uint32_t)parentIds.size();
+        values.push_back(node->data);
+        parentIds.push_back(parent);
+        if (node->nextSibling && node != tree.getRoot())
+            stack.push_back({node->nextSibling.get(), parent});
+        if (node->firstChild)
+            stack.push_back({node->firstChild.get(), id});
+    }
+    byValue.resize(values.size());
+    parallelChunks(threads, values.size(), [&](unsigned, size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i)
+            byValue[i] = {values[i], (uint32_t)i};
+    });
+    std::sort(byValue.begin(), byValue.end());
+}
+
+// CSR 的结点下标已按值升序，byValue 只需换成先根序号，不必排序
+template <typename T>
+PreorderLayout<T>::PreorderLayout(const CsrTree<T> &tree, unsigned threads) {
+    std::vector<uint32_t> preOf(tree.size(), NONE);
+    if (tree.root() == CsrTree<T>::NONE)
+        return;
+    tree.preOrder(tree.root(), [&](uint32_t v) {
+        uint32_t p = tree.parent(v);
+        preOf[v] = (uint32_t)parentIds.size();
+        values.push_back(tree.value(v));
+        parentIds.push_back(p == CsrTree<T>::NONE ? NONE : preOf[p]);
+    });
+    byValue.resize(tree.size());
+    parallelChunks(threads, tree.size(), [&](unsigned, size_t b, size_t e) {
+        for (size_t v = b; v < e; ++v)
+            byValue[v] = {tree.value((uint32_t)v), preOf[v]};
+    });
+    // 不在第一棵树里的结点没有先根序号
+    byValue.erase(std::remove_if(byValue.begin(), byValue.end(),
+                                 [](const auto &p) { return p.second == NONE; }),
+                  byValue.end());
+}
+
+template <typename T> uint32_t PreorderLayout<T>::id(const T &val) const {
+    auto it = std::lower_bound(
+        byValue.begin(), byValue.end(), val,
+        [](const std::pair<T, uint32_t> &p, const T &x) { return p.first < x; });
+    return it != byValue.end() && it->first == val ? it->second : NONE;
+}
+
+template <typename T> size_t PreorderLayout<T>::memoryBytes() const {
+    return values.capacity() * sizeof(T) +
+           parentIds.capacity() * sizeof(uint32_t) +
+           byValue.capacity() * sizeof(std::pair<T, uint32_t>);
+}
+
+template class PreorderLayout<int>;
+template class PreorderLayout<long long>;
+template class PreorderLayout<std::string>;
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "csr_tree.h"
+#include "tree.h"
+
+// 先根编号的只读树：结点按先根次序编为 0 … n-1，根为 0，非根结点的父结点序号小于自身。
+// 由 Tree 或 CsrTree 得到，供 AncestorIndex、WeightedTree 等查询结构共用
+template <typename T> class PreorderLayout {
+  public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    // 输入为森林时只取第一棵树；threads 为 0 时取硬件线程数
+    explicit PreorderLayout(const Tree<T> &tree, unsigned threads = 0);
+    explicit PreorderLayout(const CsrTree<T> &tree, unsigned threads = 0);
+
+    size_t size() const { return parentIds.size(); }
+    // 值为 val 的结点的先根序号，不存在时为 NONE
+    uint32_t id(const T &val) const;
+    const T &value(uint32_t v) const { return values[v]; }
+    // 根的父结点为 NONE
+    uint32_t parent(uint32_t v) const { return parentIds[v]; }
+    const std::vector<uint32_t> &parents() const { return parentIds; }
+
+    size_t memoryBytes() const;
+
+  private:
+    std::vector<T> values;
+    std::vector<uint32_t> parentIds;
+    // 按值排序的 (值, 先根序号)
+    std::vector<std::pair<T, uint32_t>> byValue;
+};
@@ -0,0 +1,472 @@
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <malloc.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ancestor_index.h"
+#include "csr_tree.h"
+#include "edge_loader.h"
+#include "forest_stats.h"
+#include "path_stream.h"
+#include "tree.h"
+#include "weighted_tree.h"
+
+// 序偶（父, 子）：random 为每个结点随机挂到此前的某个结点下、编号随机打乱；
+// wide 为根下挂 n - 1 个孩子；deep 为 n 个结点的单链；
+// caterpillar 为约 n / 2 个结点的单链，每个链上结点再挂一个叶子
+std::vector<std::pair<int, int>> makeEdges(const std::string &shape, size_t n) {
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(n - 1);
+    std::mt19937 rng(42);
+    std::vector<int> id(n);
+    std::iota(id.begin(), id.end(), 1);
+    if (shape == "random")
+        std::shuffle(id.begin() + 1, id.end(), rng);
+    for (size_t i = 1; i < n; ++i) {
+        size_t p = shape == "wide"          ? 0
+                   : shape == "deep"        ? i - 1
+                   : shape == "caterpillar" ? (i % 2 ? i - 1 : i - 2)
+                                            : rng() % i;
+        edges.push_back({id[p], id[i]});
+    }
+    if (shape == "random")
+        std::shuffle(edges.begin(), edges.end(), rng);
+    return edges;
+}
+
+// 森林的序偶：各树大小服从重尾分布（平均约 avg 个结点，少数树很大），
+// 树内每个结点随机挂到本树此前的某个结点下，编号 1..n 连续
+std::vector<std::pair<int, int>> forestEdges(size_t n, size_t avg) {
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(n);
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (size_t first = 1; first <= n;) {
+        size_t size = 2 + (size_t)(avg * 0.2 / std::pow(1.0 - unit(rng), 0.9));
+        size = std::min(size, n + 1 - first);
+        for (size_t i = 1; i < size; ++i)
+            edges.push_back({int(first + rng() % i), int(first + i)});
+        first += size;
+    }
+    return edges;
+}
+
+// 当前堆占用字节数（含 mmap 分配的大块）
+size_t heapBytesInUse() {
+    struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+}
+
+template <typename F> double timeIt(F &&f) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    f();
+    auto t1 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(t1 - t0).count();
+}
+
+// 逐结点 new 的构造函数与 CSR 批量构建：构建耗时、每结点内存，以及 CSR 上遍历与求高度的耗时
+void profileBuild(const std::string &shape, size_t n, unsigned maxThreads) {
+    auto edges = makeEdges(shape, n);
+    std::cout << shape << " n=" << n << std::endl;
+    {
+        size_t heap0 = heapBytesInUse();
+        Tree<int> *tree = nullptr;
+        double t = timeIt([&] { tree = new Tree<int>(edges); });
+        size_t bytes = heapBytesInUse() - heap0;
+        double td = timeIt([&] { delete tree; });
+        std::cout << "  Tree(pairs): build " << t << "s, " << double(bytes) / n
+                  << " bytes/node, destroy " << td << "s" << std::endl;
+    }
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        size_t heap0 = heapBytesInUse();
+        CsrTree<int> csr;
+        double t = timeIt([&] { csr = CsrTree<int>(edges, threads); });
+        size_t bytes = heapBytesInUse() - heap0;
+        std::cout << "  CsrTree threads=" << threads << ": build " << t << "s, "
+                  << double(bytes) / n << " bytes/node" << std::endl;
+        if (threads * 2 > maxThreads) {
+            size_t sink = 0;
+            int h = 0;
+            double tp = timeIt([&] { csr.preOrder([&](uint32_t v) { sink += v; }); });
+            double tq = timeIt([&] { csr.postOrder([&](uint32_t v) { sink ^= v; }); });
+            double th = timeIt([&] { h = csr.getHeight(); });
+            double tg = timeIt([&] {
+                for (uint32_t v = 0; v < csr.size(); ++v)
+                    sink += csr.degree(v);
+            });
+            std::cout << "  CsrTree: preOrder " << tp << "s, postOrder " << tq
+                      << "s, degrees " << tg << "s, height " << h << " in "
+                      << th << "s (checksum " << sink << ")" << std::endl;
+        }
+    }
+}
+
+// 孩子兄弟树在极宽、极深时的遍历、度、高度、路径与析构；这些操作都不随兄弟链或深度递归
+void profileTraverse(const std::string &shape, size_t n) {
+    Tree<int> *tree = nullptr;
+    double tb = timeIt([&] { tree = new Tree<int>(makeEdges(shape, n)); });
+    size_t sink = 0, leaves = 0, pathNodes = 0;
+    int h = 0;
+    std::cout << shape << " n=" << n << std::endl;
+    double tp = timeIt(
+        [&] { tree->preOrder([&](const TreeNode<int> &v) { sink += v.data; }); });
+    double tq = timeIt([&] {
+        tree->postOrder([&](const TreeNode<int> &v) { sink ^= v.data; });
+    });
+    double tr = timeIt([&] {
+        for (int v : tree->preOrderRange())
+            sink += v;
+    });
+    double tg = timeIt([&] {
+        tree->forEachDegree([&](const TreeNode<int> &, int d) { sink += d; });
+    });
+    double th = timeIt([&] { h = tree->getHeight(); });
+    double tl = timeIt([&] {
+        tree->forEachPath([&](const std::vector<int> &path) {
+            ++leaves;
+            pathNodes += path.size();
+        });
+    });
+    double td = timeIt([&] { delete tree; });
+    std::cout << "  build " << tb << "s, preOrder " << tp << "s, postOrder "
+              << tq << "s, preOrderRange " << tr << "s, degrees " << tg
+              << "s" << std::endl;
+    std::cout << "  height " << h << " in " << th << "s, paths " << leaves
+              << " (" << pathNodes << " nodes) in " << tl << "s, destroy "
+              << td << "s (checksum " << sink << ")" << std::endl;
+}
+
+// LCA 与 k 级祖先：预处理耗时（按线程数）与内存，单次、批量查询吞吐，
+// 以及沿父指针逐层上爬的朴素做法
+void profileAncestors(const std::string &shape, size_t n, unsigned maxThreads) {
+    using Index = AncestorIndex<int>;
+    CsrTree<int> csr(makeEdges(shape, n));
+    std::cout << shape << " n=" << n << " height=" << csr.getHeight()
+              << std::endl;
+    std::unique_ptr<Index> index;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        double t = timeIt([&] { index = std::make_unique<Index>(csr, threads); });
+        std::cout << "  preprocess threads=" << threads << ": " << t << "s"
+                  << std::endl;
+    }
+    std::cout << "  memory: " << double(index->memoryBytes()) / n
+              << " bytes/node" << std::endl;
+
+    std::mt19937 rng(5);
+    constexpr size_t queries = 4'000'000;
+    std::vector<Index::Query> lcaQueries(queries), laQueries(queries);
+    for (size_t i = 0; i < queries; ++i) {
+        uint32_t u = rng() % n, v = rng() % n;
+        lcaQueries[i] = {u, v};
+        laQueries[i] = {u, rng() % (index->depth(u) + 1)};
+    }
+    std::vector<uint32_t> out(queries);
+    size_t sink = 0;
+    double ts = timeIt([&] {
+        for (const auto &q : lcaQueries)
+            sink += index->lca(q.first, q.second);
+    });
+    double tl = timeIt([&] {
+        for (const auto &q : laQueries)
+            sink += index->levelAncestor(q.first, q.second);
+    });
+    std::cout << "  queries/s: lca " << queries / ts << ", level ancestor "
+              << queries / tl << std::endl;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        double tb = timeIt([&] { index->lca(lcaQueries, out, threads); });
+        double tk = timeIt([&] { index->levelAncestor(laQueries, out, threads); });
+        std::cout << "  batch threads=" << threads << ": lca "
+                  << queries / tb << "/s, level ancestor " << queries / tk
+                  << "/s" << std::endl;
+    }
+    // 朴素做法：先把深者爬到同一层，再两者一起上爬；总步数约 10^8 时停下
+    size_t steps = 0, done = 0;
+    double tn = timeIt([&] {
+        for (; done < queries && steps < 100'000'000; ++done) {
+            auto [u, v] = lcaQueries[done];
+            for (; index->depth(u) > index->depth(v); ++steps)
+                u = index->parent(u);
+            for (; index->depth(v) > index->depth(u); ++steps)
+                v = index->parent(v);
+            for (; u != v; ++steps) {
+                u = index->parent(u);
+                v = index->parent(v);
+            }
+            sink += u;
+        }
+    });
+    std::cout << "  naive climb: " << done / tn << " lca/s (checksum " << sink
+              << ")" << std::endl;
+}
+
+// 带权树的混合负载：一半修改权值，其余一半为子树聚合、一半为到根路径聚合；
+// 对比在 CSR 上逐个访问子树、沿父结点上爬的朴素做法
+void profileAggregates(const std::string &shape, size_t n) {
+    using Weighted = WeightedTree<int>;
+    CsrTree<int> csr(makeEdges(shape, n));
+    Weighted *tree = nullptr;
+    double tb = timeIt([&] { tree = new Weighted(csr, 1); });
+    std::cout << shape << " n=" << n << std::endl;
+    std::cout << "  build " << tb << "s, "
+              << double(tree->memoryBytes()) / n << " bytes/node" << std::endl;
+
+    // 朴素做法用的权值按 CSR 下标存放，查询前换算
+    std::vector<uint32_t> csrOf(n);
+    for (uint32_t v = 0; v < n; ++v)
+        csrOf[v] = csr.find(tree->value(v));
+    std::vector<long long> weights(n, 1);
+
+    struct Op {
+        int kind; // 0 修改，1 子树，2 到根路径
+        uint32_t v;
+        long long w;
+    };
+    std::mt19937 rng(3);
+    constexpr size_t ops = 2'000'000;
+    std::vector<Op> workload(ops);
+    for (auto &op : workload)
+        op = {rng() % 2 ? 0 : 1 + int(rng() % 2), uint32_t(rng() % n),
+              (long long)(rng() % 1000)};
+
+    long long sink = 0;
+    double ti = timeIt([&] {
+        for (const Op &op : workload) {
+            if (op.kind == 0)
+                tree->setWeight(op.v, op.w);
+            else if (op.kind == 1)
+                sink += tree->subtree(op.v).sum;
+            else
+                sink += tree->pathToRoot(op.v).max;
+        }
+    });
+    // 朴素做法：总步数约 10^8 时停下
+    size_t steps = 0, done = 0;
+    std::vector<uint32_t> stack;
+    double tn = timeIt([&] {
+        for (; done < ops && steps < 100'000'000; ++done) {
+            const Op &op = workload[done];
+            uint32_t v = csrOf[op.v];
+            if (op.kind == 0) {
+                weights[v] = op.w;
+            } else if (op.kind == 1) {
+                long long sum = 0;
+                stack.assign(1, v);
+                while (!stack.empty()) {
+                    uint32_t u = stack.back();
+                    stack.pop_back();
+                    sum += weights[u];
+                    ++steps;
+                    for (uint32_t c : csr.children(u))
+                        stack.push_back(c);
+                }
+                sink += sum;
+            } else {
+                long long max = LLONG_MIN;
+                for (; v != CsrTree<int>::NONE; v = csr.parent(v), ++steps)
+                    max = std::max(max, weights[v]);
+                sink += max;
+            }
+        }
+    });
+    std::cout << "  mixed ops/s: euler+hld " << ops / ti << ", naive "
+              << done / tn << " (checksum " << sink << ")" << std::endl;
+    delete tree;
+}
+
+// 森林的逐树统计在 1…maxThreads 个线程上的扩展性，以及缓冲 CSV 与逐行 std::endl 的写出耗时
+void profileForest(size_t n, unsigned maxThreads) {
+    auto edges = forestEdges(n, 100);
+    CsrTree<int> csr(edges);
+    Tree<int> tree(edges);
+    edges = {};
+    std::cout << "forest n=" << n << " trees=" << csr.roots().size()
+              << std::endl;
+    // 先各跑一遍预热，避免第一轮计入缺页
+    std::vector<ComponentStats<int>> stats = componentStats(csr, 1);
+    stats = componentStats(tree, 1);
+    double base = 0, baseTree = 0;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        double tc = timeIt([&] { stats = componentStats(csr, threads); });
+        double tt = timeIt([&] { stats = componentStats(tree, threads); });
+        if (threads == 1)
+            base = tc, baseTree = tt;
+        std::cout << "  threads=" << threads << ": CsrTree " << tc << "s (x"
+                  << base / tc << "), Tree " << tt << "s (x" << baseTree / tt
+                  << ")" << std::endl;
+    }
+    std::string path = "/tmp/ex5_profile_forest.csv";
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    double tw = timeIt([&] { writeComponentStats(stats, f); });
+    long bytes = std::ftell(f);
+    std::fclose(f);
+    double tl = timeIt([&] {
+        std::ofstream out(path);
+        out << "root,nodes,height,max_degree,leaves,path_nodes" << std::endl;
+        for (const auto &s : stats)
+            out << s.root << ',' << s.nodes << ',' << s.height << ','
+                << s.maxDegree << ',' << s.leaves << ',' << s.pathNodes
+                << std::endl;
+    });
+    std::cout << "  write " << bytes << "B: buffered " << tw
+              << "s, per-line endl " << tl << "s" << std::endl;
+    std::remove(path.c_str());
+}
+
+// 根到叶子的路径：printPaths 的完整输出与前缀压缩输出的字节数和耗时，以及不生成路径的聚合。
+// 完整输出的规模为各路径结点数之和，超过 limit 个结点时跳过
+void profilePaths(const std::string &shape, size_t n) {
+    const uint64_t limit = 50'000'000;
+    Tree<int> tree(makeEdges(shape, n));
+    PathSummary sum;
+    double ts = timeIt([&] { sum = summarizePaths(tree); });
+    std::cout << shape << " n=" << n << " paths=" << sum.paths
+              << " longest=" << sum.lengthCounts.size() - 1
+              << " path_nodes=" << sum.pathNodes << std::endl;
+    long long total = 0;
+    double tp = timeIt([&] {
+        forEachPathSum<long long>(
+            tree, [&](const TreeNode<int> &, long long s) { total += s; });
+    });
+    std::cout << "  summarizePaths " << ts << "s, forEachPathSum " << tp
+              << "s (sum " << total << ")" << std::endl;
+
+    std::string path = "/tmp/ex5_profile_paths.txt";
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    uint64_t bytes = 0;
+    double tw = timeIt([&] { writePathDeltas(tree, f, &bytes); });
+    std::fclose(f);
+    std::cout << "  prefix-compressed " << bytes << "B " << tw << "s";
+    if (sum.pathNodes > limit) {
+        std::cout << ", full output skipped" << std::endl;
+    } else {
+        std::ofstream out(path, std::ios::binary);
+        std::streambuf *saved = std::cout.rdbuf(out.rdbuf());
+        double tf = timeIt([&] {
+            tree.printPaths();
+            std::cout.flush();
+        });
+        std::cout.rdbuf(saved);
+        std::cout << ", printPaths " << (uint64_t)out.tellp() << "B " << tf
+                  << "s" << std::endl;
+    }
+    std::remove(path.c_str());
+}
+
+// 在子进程中执行 fn，返回子进程的峰值 RSS（MiB），各次测量互不影响
+template <typename F> double peakRssMiB(F &&fn) {
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+        fn();
+        std::cout.flush();
+        _exit(0);
+    }
+    int status = 0;
+    struct rusage ru {};
+    wait4(pid, &status, 0, &ru);
+    return ru.ru_maxrss / 1024.0;
+}
+
+// 边表导入：mmap 二进制边表直接建 CsrTree / Tree（不经中间数组），并行 CSV 解析后建 CsrTree，
+// 以及逐行 ifstream 读入的做法；报告吞吐量（MB/s）与各自子进程的峰值 RSS
+void profileIngest(size_t n, unsigned maxThreads) {
+    std::string bin = "/tmp/ex5_profile_edges.bin";
+    std::string csv = "/tmp/ex5_profile_edges.csv";
+    {
+        auto edges = makeEdges("random", n);
+        writeEdgeFile<int>(bin, edges);
+        std::FILE *f = std::fopen(csv.c_str(), "wb");
+        for (const auto &[p, c] : edges)
+            std::fprintf(f, "%d,%d\n", p, c);
+        std::fclose(f);
+    }
+    auto fileMB = [](const std::string &path) {
+        struct stat st;
+        return ::stat(path.c_str(), &st) == 0 ? st.st_size / 1e6 : 0.0;
+    };
+    double binMB = fileMB(bin), csvMB = fileMB(csv);
+    std::cout << "ingest n=" << n << " binary " << binMB << "MB, csv "
+              << csvMB << "MB" << std::endl;
+    auto report = [&](const std::string &label, double mb, auto &&load) {
+        double rss = peakRssMiB([&] {
+            double t = timeIt(load);
+            std::cout << "  " << label << ": " << t << "s, " << mb / t
+                      << "MB/s, " << n / t / 1e6 << "M edges/s";
+        });
+        std::cout << ", peak RSS " << rss << "MiB" << std::endl;
+    };
+    report("mmap binary -> CsrTree", binMB, [&] {
+        MappedEdges<int> edges(bin);
+        CsrTree<int> csr(edges.data(), edges.size(), maxThreads);
+    });
+    // 逐结点 new 的 Tree 在千万级时要数分钟，只测到百万
+    if (n <= 1'000'000)
+        report("mmap binary -> Tree", binMB, [&] {
+            MappedEdges<int> edges(bin);
+            Tree<int> tree(edges.data(), edges.size());
+        });
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+        report("parseEdgeCsv threads=" + std::to_string(threads) +
+                   " -> CsrTree",
+               csvMB, [&] {
+                   CsrTree<int> csr(parseEdgeCsv<int>(csv, threads),
+                                    maxThreads);
+               });
+    report("ifstream csv -> CsrTree", csvMB, [&] {
+        std::ifstream in(csv);
+        std::vector<std::pair<int, int>> edges;
+        int p, c;
+        char comma;
+        while (in >> p >> comma >> c)
+            edges.push_back({p, c});
+        CsrTree<int> csr(edges, maxThreads);
+    });
+    std::remove(bin.c_str());
+    std::remove(csv.c_str());
+}
+
+int main(int argc, char **argv) {
+    std::string what = argc > 1 ? argv[1] : "all";
+    size_t maxN = argc > 2 ? std::stoull(argv[2]) : 10'000'000;
+    unsigned maxThreads =
+        argc > 3 ? std::stoul(argv[3])
+                 : std::max(1u, std::thread::hardware_concurrency());
+    for (size_t n = 1'000; n <= maxN; n *= 10) {
+        if (what == "build" || what == "all")
+            for (const char *shape : {"random", "wide", "deep"})
+                profileBuild(shape, n, maxThreads);
+        if (what == "lca" || what == "all")
+            for (const char *shape : {"random", "wide", "deep"})
+                profileAncestors(shape, n, maxThreads);
+        if (what == "aggregate" || what == "all")
+            for (const char *shape : {"random", "wide", "deep"})
+                profileAggregates(shape, n);
+        if (what == "forest" || what == "all")
+            profileForest(n, maxThreads);
+        if (what == "traverse" || what == "all")
+            for (const char *shape : {"wide", "deep"})
+                profileTraverse(shape, n);
+        if (what == "paths" || what == "all")
+            for (const char *shape : {"random", "caterpillar"})
+                profilePaths(shape, n);
+        if (what == "ingest" || what == "all")
+            profileIngest(n, maxThreads);
+    }
+    return 0;
+}
@@ -1,67 +1,94 @@
+#include <algorithm>
 #include <iostream>
 #include <set>
+#include <span>
+#include <string>
 #include <unordered_map>
 
 #include "tree.h"
 
-template <typename T> Tree<T>::Tree(const std::vector<std::pair<T, T>> &pairs) {
+template <typename T>
+Tree<T>::Tree(const std::vector<std::pair<T, T>> &pairs)
+    : Tree(pairs.data(), pairs.size()) {}
+
+template <typename T>
+Tree<T>::Tree(const std::pair<T, T> *pairs, size_t count) {
     std::unordered_map<T, TreeNode<T> *> nodes;
+    std::vector<TreeNode<T> *> created;
+    // 每个结点最后一个孩子，追加孩子时不必走完兄弟链
+    std::unordered_map<T, TreeNode<T> *> lastChild;
     std::set<T> children;
-    for (const auto &p : pairs) {
-        if (!nodes.count(p.first))
-            nodes[p.first] = new TreeNode<T>(p.first);
-        if (!nodes.count(p.second))
-            nodes[p.second] = new TreeNode<T>(p.second);
+    for (const auto &p : std::span(pairs, count)) {
+        for (const T &v : {p.first, p.second}) {
+            if (!nodes.count(v))
+                created.push_back(nodes[v] = new TreeNode<T>(v));
+        }
         TreeNode<T> *parent = nodes[p.first];
         TreeNode<T> *child = nodes[p.second];
-        if (!parent->firstChild) {
+        TreeNode<T> *&last = lastChild[p.first];
+        if (!last)
             parent->firstChild.reset(child);
-        } else {
-            TreeNode<T> *sib = parent->firstChild.get();
-            while (sib->nextSibling)
-                sib = sib->nextSibling.get();
-            sib->nextSibling.reset(child);
-        }
+        else
+            last->nextSibling.reset(child);
+        last = child;
         children.insert(p.second);
     }
-    for (const auto &kv : nodes) {
-        if (!children.count(kv.first)) {
-            root.reset(kv.second);
-            break;
-        }
+    // 没有父结点的都是根，按首次出现的次序串成兄弟链，一棵也不丢
+    TreeNode<T> *lastRoot = nullptr;
+    for (TreeNode<T> *n : created) {
+        if (children.count(n->data))
+            continue;
+        if (lastRoot)
+            lastRoot->nextSibling.reset(n);
+        else
+            root.reset(n);
+        lastRoot = n;
+    }
+}
+
+template <typename T> Tree<T>::~Tree() {
+    std::vector<std::unique_ptr<TreeNode<T>>> stack;
+    if (root)
+        stack.push_back(std::move(root));
+    while (!stack.empty()) {
+        std::unique_ptr<TreeNode<T>> node = std::move(stack.back());
+        stack.pop_back();
+        if (node->firstChild)
+            stack.push_back(std::move(node->firstChild));
+        if (node->nextSibling)
+            stack.push_back(std::move(node->nextSibling));
     }
 }
 
+// 旧树交给临时对象，由它的析构函数逐个释放
+template <typename T> Tree<T> &Tree<T>::operator=(Tree &&other) noexcept {
+    Tree old(std::move(other));
+    std::swap(root, old.root);
+    return *this;
+}
+
 template <typename T> const TreeNode<T> *Tree<T>::getRoot() const {
     return root.get();
 }
 
-template <typename T> void Tree<T>::preOrder() const {
-    preOrder(root.get());
-    std::cout << std::endl;
+template <typename T>
+std::vector<const TreeNode<T> *> Tree<T>::getRoots() const {
+    std::vector<const TreeNode<T> *> roots;
+    for (auto r = root.get(); r; r = r->nextSibling.get())
+        roots.push_back(r);
+    return roots;
 }
 
-template <typename T> void Tree<T>::preOrder(TreeNode<T> *node) const {
-    if (!node)
-        return;
-    std::cout << node->data << " ";
-    preOrder(node->firstChild.get());
-    preOrder(node->nextSibling.get());
+template <typename T> void Tree<T>::preOrder() const {
+    preOrder([](const TreeNode<T> &n) { std::cout << n.data << " "; });
+    std::cout << std::endl;
 }
 
 template <typename T> void Tree<T>::postOrder() const {
-    postOrder(root.get());
+    postOrder([](const TreeNode<T> &n) { std::cout << n.data << " "; });
     std::cout << std::endl;
 }
 
-template <typename T> void Tree<T>::postOrder(TreeNode<T> *node) const {
-    if (!node)
-        return;
-    postOrder(node->firstChild.get());
-    std::cout << node->data << " ";
-    postOrder(node->nextSibling.get());
-}
-
 template <typename T> int Tree<T>::getDegree(const TreeNode<T> *node) const {
     int deg = 0;
     auto child = node->firstChild.get();
@@ -73,57 +100,38 @@ template <typename T> int Tree<T>::getDegree(const TreeNode<T> *node) const {
 }
 
 template <typename T> void Tree<T>::printDegrees() const {
-    printDegrees(root.get());
-}
-
-template <typename T> void Tree<T>::printDegrees(TreeNode<T> *node) const {
-    if (!node)
-        return;
-    std::cout << "结点 " << node->data << " 的度: " << getDegree(node)
-              << std::endl;
-    printDegrees(node->firstChild.get());
-    printDegrees(node->nextSibling.get());
+    forEachDegree([](const TreeNode<T> &n, int deg) {
+        std::cout << "结点 " << n.data << " 的度: " << deg << std::endl;
+    });
 }
 
+// 兄弟与自己同层，长子深一层；栈中存 (结点, 层数)。森林的高度取各树高度的最大值
 template <typename T> int Tree<T>::getHeight() const {
-    return getHeight(root.get());
-}
-
-template <typename T> int Tree<T>::getHeight(const TreeNode<T> *node) const {
-    if (!node)
+    if (!root)
         return 0;
     int maxH = 0;
-    for (auto child = node->firstChild.get(); child;
-         child = child->nextSibling.get()) {
-        int h = getHeight(child);
-        if (h > maxH)
-            maxH = h;
+    std::vector<std::pair<const TreeNode<T> *, int>> stack{{root.get(), 1}};
+    while (!stack.empty()) {
+        auto [node, h] = stack.back();
+        stack.pop_back();
+        maxH = std::max(maxH, h);
+        if (node->nextSibling)
+            stack.push_back({node->nextSibling.get(), h});
+        if (node->firstChild)
+            stack.push_back({node->firstChild.get(), h + 1});
     }
-    return maxH + 1;
+    return maxH;
 }
 
 template <typename T> void Tree<T>::printPaths() const {
-    std::vector<T> path;
-    printPaths(root.get(), path);
-}
-
-template <typename T>
-void Tree<T>::printPaths(TreeNode<T> *node, std::vector<T> &path) const {
-    if (!node)
-        return;
-    path.push_back(node->data);
-    if (!node->firstChild) {
+    forEachPath([](const std::vector<T> &path) {
         std::cout << "路径: ";
         for (size_t i = 0; i < path.size(); ++i) {
             std::cout << path[i] << (i + 1 == path.size() ? "\n" : " -> ");
         }
-    } else {
-        for (auto child = node->firstChild.get(); child;
-             child = child->nextSibling.get()) {
-            printPaths(child, path);
-        }
-    }
-    path.pop_back();
+    });
 }
 
 template class Tree<int>;
+template class Tree<long long>;
+template class Tree<std::string>;
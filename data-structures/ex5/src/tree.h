@@ -1,4 +1,6 @@
 #pragma once
+#include <cstddef>
+#include <iterator>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -12,21 +14,149 @@ template <typename T> struct TreeNode {
 
 template <typename T> class Tree {
   private:
+    // 森林：各棵树的根按在序偶中首次出现的次序用 nextSibling 串成一条链
     std::unique_ptr<TreeNode<T>> root;
     TreeNode<T> *findNode(TreeNode<T> *node, const T &val);
-    void preOrder(TreeNode<T> *node) const;
-    void postOrder(TreeNode<T> *node) const;
     int getDegree(const TreeNode<T> *node) const;
-    int getHeight(const TreeNode<T> *node) const;
-    void printPaths(TreeNode<T> *node, std::vector<T> &path) const;
-    void printDegrees(TreeNode<T> *node) const;
 
   public:
+    // 孩子兄弟表示下，森林的先根次序即二叉形式（firstChild 为左、nextSibling 为右）的先序，
+    // 后根次序即其中序。两者都用显式栈，栈深 O(高度)，不随兄弟链递归
+    enum class Order { Pre, Post };
+
+    // 单趟输入范围，遍历从 root 起的整条兄弟链（即以它们为根的森林）；
+    // 迭代器指向所属 Traversal 的状态
+    template <Order O> class Traversal {
+      public:
+        class iterator {
+          public:
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+
+            explicit iterator(Traversal *walk) : walk(walk) {}
+
+            const T &operator*() const { return walk->cur->data; }
+            const TreeNode<T> *node() const { return walk->cur; }
+            iterator &operator++() {
+                walk->advance();
+                return *this;
+            }
+            void operator++(int) { walk->advance(); }
+            bool operator==(std::default_sentinel_t) const {
+                return walk->cur == nullptr;
+            }
+
+          private:
+            Traversal *walk;
+        };
+
+        explicit Traversal(const TreeNode<T> *root) : root(root) {}
+
+        iterator begin() {
+            stack.clear();
+            next = nullptr;
+            if constexpr (O == Order::Pre) {
+                if (root)
+                    stack.push_back(root);
+            } else {
+                next = root;
+            }
+            advance();
+            return iterator(this);
+        }
+        std::default_sentinel_t end() const { return {}; }
+
+      private:
+        const TreeNode<T> *root;
+        const TreeNode<T> *cur = nullptr;  // 当前产出的结点，nullptr 表示结束
+        const TreeNode<T> *next = nullptr; // 后根：下一段要压栈的长子链起点
+        std::vector<const TreeNode<T> *> stack;
+
+        void advance() {
+            cur = nullptr;
+            if constexpr (O == Order::Pre) {
+                if (stack.empty())
+                    return;
+                cur = stack.back();
+                stack.pop_back();
+                if (cur->nextSibling)
+                    stack.push_back(cur->nextSibling.get());
+                if (cur->firstChild)
+                    stack.push_back(cur->firstChild.get());
+            } else {
+                for (; next; next = next->firstChild.get())
+                    stack.push_back(next);
+                if (stack.empty())
+                    return;
+                cur = stack.back();
+                stack.pop_back();
+                next = cur->nextSibling.get();
+            }
+        }
+    };
+
     Tree(const std::vector<std::pair<T, T>> &pairs);
+    // 直接读取外部的序偶数组（如 MappedEdges 映射的文件），不复制
+    Tree(const std::pair<T, T> *pairs, size_t count);
+    // 逐个摘下孩子与兄弟再释放，避免 unique_ptr 链式析构的递归
+    ~Tree();
+    Tree(Tree &&) noexcept = default;
+    Tree &operator=(Tree &&other) noexcept;
+
+    Traversal<Order::Pre> preOrderRange() const {
+        return Traversal<Order::Pre>(root.get());
+    }
+    Traversal<Order::Post> postOrderRange() const {
+        return Traversal<Order::Post>(root.get());
+    }
+
+    // 访问者接口：visit(const TreeNode<T> &)
+    template <typename F> void preOrder(F &&visit) const {
+        auto walk = preOrderRange();
+        for (auto it = walk.begin(); it != std::default_sentinel; ++it)
+            visit(*it.node());
+    }
+    template <typename F> void postOrder(F &&visit) const {
+        auto walk = postOrderRange();
+        for (auto it = walk.begin(); it != std::default_sentinel; ++it)
+            visit(*it.node());
+    }
+    // 按先根次序 visit(const TreeNode<T> &, int 度)
+    template <typename F> void forEachDegree(F &&visit) const {
+        preOrder([&](const TreeNode<T> &n) { visit(n, getDegree(&n)); });
+    }
+    // 对每个叶子 visit(const std::vector<T> &根到叶子的路径)
+    template <typename F> void forEachPath(F &&visit) const;
+
     void preOrder() const;
     void postOrder() const;
     void printDegrees() const;
     int getHeight() const;
     void printPaths() const;
+    // 第一棵树的根，其余各树的根沿 nextSibling 依次排列
     const TreeNode<T> *getRoot() const;
+    // 各棵树的根
+    std::vector<const TreeNode<T> *> getRoots() const;
 };
+
+template <typename T>
+template <typename F>
+void Tree<T>::forEachPath(F &&visit) const {
+    if (!root)
+        return;
+    // 栈中存 (结点, 它在路径中的下标)；弹出时先把路径截到它的父结点
+    std::vector<std::pair<const TreeNode<T> *, size_t>> stack{{root.get(), 0}};
+    std::vector<T> path;
+    while (!stack.empty()) {
+        auto [node, depth] = stack.back();
+        stack.pop_back();
+        path.erase(path.begin() + depth, path.end());
+        path.push_back(node->data);
+        if (node->nextSibling)
+            stack.push_back({node->nextSibling.get(), depth});
+        if (node->firstChild)
+            stack.push_back({node->firstChild.get(), depth + 1});
+        else
+            visit(path);
+    }
+}
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <bit>
+#include <string>
+
+#include "weighted_tree.h"
+
+template <typename T>
+WeightedTree<T>::WeightedTree(const Tree<T> &tree, Weight initial)
+    : layout(tree) {
+    build(initial);
+}
+
+template <typename T>
+WeightedTree<T>::WeightedTree(const CsrTree<T> &tree, Weight initial)
+    : layout(tree) {
+    build(initial);
+}
+
+// 先根序中父结点在前，逆序一遍即可累计子树大小并选出重孩子；
+// 再按父结点计数排序得到孩子表，用显式栈排出重孩子优先的次序
+template <typename T> void WeightedTree<T>::build(Weight initial) {
+    const std::vector<uint32_t> &parents = layout.parents();
+    size_t n = parents.size();
+    sizes.assign(n, 1);
+    std::vector<uint32_t> heavy(n, NONE);
+    for (size_t v = n; v-- > 1;) {
+        uint32_t p = parents[v];
+        sizes[p] += sizes[v];
+        if (heavy[p] == NONE || sizes[v] >= sizes[heavy[p]])
+            heavy[p] = (uint32_t)v;
+    }
+
+    std::vector<uint32_t> offsets(n + 1, 0), children(n ? n - 1 : 0);
+    for (size_t v = 1; v < n; ++v)
+        ++offsets[parents[v] + 1];
+    for (size_t v = 0; v < n; ++v)
+        offsets[v + 1] += offsets[v];
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (size_t v = 1; v < n; ++v)
+        children[cursor[parents[v]]++] = (uint32_t)v;
+
+    pos.resize(n);
+    head.resize(n);
+    std::vector<uint32_t> stack;
+    if (n) {
+        head[0] = 0;
+        stack.push_back(0);
+    }
+    uint32_t next = 0;
+    while (!stack.empty()) {
+        uint32_t v = stack.back();
+        stack.pop_back();
+        pos[v] = next++;
+        for (uint32_t i = offsets[v + 1]; i-- > offsets[v];) {
+            uint32_t c = children[i];
+            if (c != heavy[v]) {
+                head[c] = c;
+                stack.push_back(c);
+            }
+        }
+        if (heavy[v] != NONE) {
+            head[heavy[v]] = head[v];
+            stack.push_back(heavy[v]);
+        }
+    }
+
+    leaves = std::bit_ceil(std::max<size_t>(1, n));
+    sums.assign(2 * leaves, 0);
+    maxima.assign(2 * leaves, LLONG_MIN);
+    std::fill(sums.begin() + leaves, sums.begin() + leaves + n, initial);
+    std::fill(maxima.begin() + leaves, maxima.begin() + leaves + n, initial);
+    for (size_t i = leaves; i-- > 1;) {
+        sums[i] = sums[2 * i] + sums[2 * i + 1];
+        maxima[i] = std::max(maxima[2 * i], maxima[2 * i + 1]);
+    }
+}
+
+template <typename T> void WeightedTree<T>::setWeight(uint32_t v, Weight w) {
+    size_t i = leaves + pos[v];
+    sums[i] = maxima[i] = w;
+    for (i /= 2; i >= 1; i /= 2) {
+        sums[i] = sums[2 * i] + sums[2 * i + 1];
+        maxima[i] = std::max(maxima[2 * i], maxima[2 * i + 1]);
+    }
+}
+
+template <typename T>
+typename WeightedTree<T>::Aggregate WeightedTree<T>::query(size_t l,
+                                                           size_t r) const {
+    Aggregate a;
+    a.count = (uint32_t)(r - l);
+    for (l += leaves, r += leaves; l < r; l /= 2, r /= 2) {
+        if (l & 1) {
+            a.sum += sums[l];
+            a.max = std::max(a.max, maxima[l++]);
+        }
+        if (r & 1) {
+            a.sum += sums[--r];
+            a.max = std::max(a.max, maxima[r]);
+        }
+    }
+    return a;
+}
+
+template <typename T>
+typename WeightedTree<T>::Aggregate
+WeightedTree<T>::subtree(uint32_t v) const {
+    return query(pos[v], pos[v] + sizes[v]);
+}
+
+// 每次跳过一整条重链：链顶到 v 在次序中连续
+template <typename T>
+typename WeightedTree<T>::Aggregate
+WeightedTree<T>::pathToRoot(uint32_t v) const {
+    Aggregate a;
+    for (; v != NONE; v = layout.parent(head[v])) {
+        Aggregate part = query(pos[head[v]], pos[v] + 1);
+        a.sum += part.sum;
+        a.max = std::max(a.max, part.max);
+        a.count += part.count;
+    }
+    return a;
+}
+
+template <typename T> size_t WeightedTree<T>::memoryBytes() const {
+    return layout.memoryBytes() +
+           (sizes.capacity() + pos.capacity() + head.capacity()) *
+               sizeof(uint32_t) +
+           (sums.capacity() + maxima.capacity()) * sizeof(Weight);
+}
+
+template class WeightedTree<int>;
+template class WeightedTree<long long>;
+template class WeightedTree<std::string>;
@@ -0,0 +1,60 @@
+#pragma once
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "preorder_layout.h"
+
+// 带权树：结点权值可随时修改，子树与到根路径的和、最大值按需查询。
+// 结点以先根序号标识，与 AncestorIndex 一致。
+//
+// 按“重孩子优先”的先根次序给结点编位置（每个结点先走子树最大的孩子）：
+// 任一子树占连续一段，每条重链也占连续一段，同一棵线段树既回答子树聚合，
+// 也逐条重链回答到根路径的聚合。修改 O(log n)，子树查询 O(log n)，
+// 到根路径经过 O(log n) 条重链，查询 O(log^2 n)；子树大小 O(1)
+template <typename T> class WeightedTree {
+  public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    using Weight = long long;
+
+    struct Aggregate {
+        Weight sum = 0;
+        Weight max = LLONG_MIN;
+        uint32_t count = 0;
+    };
+
+    explicit WeightedTree(const Tree<T> &tree, Weight initial = 0);
+    explicit WeightedTree(const CsrTree<T> &tree, Weight initial = 0);
+
+    size_t size() const { return layout.size(); }
+    // 值为 val 的结点的先根序号，不存在时为 NONE
+    uint32_t id(const T &val) const { return layout.id(val); }
+    const T &value(uint32_t v) const { return layout.value(v); }
+    uint32_t parent(uint32_t v) const { return layout.parent(v); }
+
+    Weight weight(uint32_t v) const { return sums[leaves + pos[v]]; }
+    void setWeight(uint32_t v, Weight w);
+    void addWeight(uint32_t v, Weight delta) { setWeight(v, weight(v) + delta); }
+
+    uint32_t subtreeSize(uint32_t v) const { return sizes[v]; }
+    // 以 v 为根的子树
+    Aggregate subtree(uint32_t v) const;
+    // 从 v 到根（含两端）的路径
+    Aggregate pathToRoot(uint32_t v) const;
+
+    size_t memoryBytes() const;
+
+  private:
+    PreorderLayout<T> layout;
+    std::vector<uint32_t> sizes;
+    std::vector<uint32_t> pos;  // 结点在重孩子优先次序中的位置
+    std::vector<uint32_t> head; // 结点所在重链的顶端
+    // 自底向上的线段树，叶子从下标 leaves 开始，1 为根
+    size_t leaves = 1;
+    std::vector<Weight> sums, maxima;
+
+    void build(Weight initial);
+    // 位置 [l, r) 上的聚合
+    Aggregate query(size_t l, size_t r) const;
+};
@@ -1,7 +1,9 @@
 #include <chrono>
+#include <format>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
 #include <sys/resource.h>
 
 #include "matrix.h"
@@ -22,6 +24,7 @@ size_t get_peak_rss_kb() {
 
 struct BenchmarkResult {
     double avg_time = 0.0;
+    double gflops = 0.0;
     double peak_mb = 0.0;
     std::string notes = "";
     bool oom = false;
@@ -37,7 +40,7 @@ static double mean(const std::vector<double> &v) {
     return s / v.size();
 }
 
-BenchmarkResult run_benchmark_for_N(size_t N, int repeats) {
+BenchmarkResult run_benchmark_for_N(size_t N, int repeats, bool naive) {
     BenchmarkResult res;
 
     try {
@@ -56,7 +59,7 @@ BenchmarkResult run_benchmark_for_N(size_t N, int repeats) {
             Matrix C(N, N);
 
             double t0 = now_seconds();
-            C = A * B;
+            C = naive ? A.multiply_naive(B) : A * B;
             double t1 = now_seconds();
 
             times.push_back(t1 - t0);
@@ -68,6 +71,8 @@ BenchmarkResult run_benchmark_for_N(size_t N, int repeats) {
         }
 
         res.avg_time = mean(times);
+        if (res.avg_time > 0.0)
+            res.gflops = 2.0 * N * N * N / res.avg_time / 1e9;
 
     } catch (const std::bad_alloc &e) {
         res.notes = std::string("OOM: ") + e.what();
@@ -81,7 +86,7 @@ BenchmarkResult run_benchmark_for_N(size_t N, int repeats) {
 
 int main(int argc, char **argv) {
     if (argc < 6) {
-        std::cerr << "Usage: " << argv[0] << " START END STEP REPEATS OUTPUT_CSV\n";
+        std::cerr << "Usage: " << argv[0] << " START END STEP REPEATS OUTPUT_CSV [blocked|naive] [MC KC NC]\n";
         std::cerr << "Example: " << argv[0] << " 100 500 100 3 results.csv\n";
         return 1;
     }
@@ -91,10 +96,18 @@ int main(int argc, char **argv) {
     size_t step = std::stoull(argv[3]);
     int repeats = std::stoi(argv[4]);
     std::string out_csv = argv[5];
+    std::string kernel = argc > 6 ? argv[6] : "blocked";
     if (step == 0) {
         std::cerr << "STEP must be > 0\n";
         return 1;
     }
+    if (kernel != "blocked" && kernel != "naive") {
+        std::cerr << "KERNEL must be blocked or naive\n";
+        return 1;
+    }
+    if (argc > 9) {
+        Matrix::set_gemm_blocking({std::stoull(argv[7]), std::stoull(argv[8]), std::stoull(argv[9])});
+    }
 
     std::ofstream fout(out_csv);
     if (!fout) {
@@ -102,32 +115,34 @@ int main(int argc, char **argv) {
         return 1;
     }
 
-    fout << "N,avg_time_s,peak_rss_MB,notes\n";
+    fout << "N,avg_time_s,gflops,peak_rss_MB,notes\n";
 
     for (size_t N = start; N <= end; N += step) {
         std::cout << "Testing N=" << N << "\n";
 
-        BenchmarkResult res = run_benchmark_for_N(N, repeats);
+        BenchmarkResult res = run_benchmark_for_N(N, repeats, kernel == "naive");
 
         if (res.skipped) {
             std::cout << "Skipping N=" << N << " (sanity check)\n";
-            fout << N << ",," << "0.00," << res.notes << "\n";
+            fout << N << ",,," << "0.00," << res.notes << "\n";
             fout.flush();
             continue;
         }
 
         if (res.oom) {
             std::cout << "Allocation failed for N=" << N << "\n";
-            fout << N << ",, ," << res.notes << "\n";
+            fout << N << ",,, ," << res.notes << "\n";
             fout.flush();
             break;
         }
 
         if (!res.notes.empty()) {
             std::cout << res.notes << "\n";
+        } else {
+            std::cout << "  " << res.gflops << " GFLOP/s\n";
         }
 
-        fout << std::format("{},{:.2f},{:.2f},{}\n", N, res.avg_time, res.peak_mb, res.notes);
+        fout << std::format("{},{:.2f},{:.2f},{:.2f},{}\n", N, res.avg_time, res.gflops, res.peak_mb, res.notes);
         fout.flush();
     }
 
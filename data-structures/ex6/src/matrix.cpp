@@ -11,7 +11,128 @@ const double &Matrix::operator()(std::size_t i, std::size_t j) const noexcept {
 double *Matrix::operator[](std::size_t i) noexcept { return &data_[i * cols_]; }
 const double *Matrix::operator[](std::size_t i) const noexcept { return &data_[i * cols_]; }
 
-Matrix Matrix::operator*(const Matrix &B) const {
+namespace {
+
+// Register tile of the microkernel: MR rows of A times NR columns of B
+constexpr std::size_t MR = 4;
+constexpr std::size_t NR = 8;
+
+GemmBlocking blocking_;
+
+std::size_t round_up(std::size_t n, std::size_t m) { return (n + m - 1) / m * m; }
+
+// Copies the mc x kc block of A at `a` into MR-row slivers, each stored column by column
+// (kc groups of MR values), so the microkernel reads it sequentially. Rows past mc are zero.
+void pack_a(const double *a, std::size_t lda, std::size_t mc, std::size_t kc, double *out) {
+    for (std::size_t i = 0; i < mc; i += MR) {
+        std::size_t m = std::min(MR, mc - i);
+        for (std::size_t p = 0; p < kc; ++p) {
+            for (std::size_t r = 0; r < m; ++r)
+                out[r] = a[(i + r) * lda + p];
+            for (std::size_t r = m; r < MR; ++r)
+                out[r] = 0.0;
+            out += MR;
+        }
+    }
+}
+
+// Copies the kc x nc panel of B at `b` into NR-column slivers, each stored row by row
+// (kc groups of NR values). Columns past nc are zero.
+void pack_b(const double *b, std::size_t ldb, std::size_t kc, std::size_t nc, double *out) {
+    for (std::size_t j = 0; j < nc; j += NR) {
+        std::size_t n = std::min(NR, nc - j);
+        for (std::size_t p = 0; p < kc; ++p) {
+            const double *row = b + p * ldb + j;
+            for (std::size_t c = 0; c < n; ++c)
+                out[c] = row[c];
+            for (std::size_t c = n; c < NR; ++c)
+                out[c] = 0.0;
+            out += NR;
+        }
+    }
+}
+
+// C[0..m) x [0..n) += packed A sliver * packed B sliver. The MR x NR accumulator lives in
+// registers for the whole kc loop, so C is touched once per block instead of once per k.
+void micro_kernel(std::size_t kc, const double *a, const double *b, double *c, std::size_t ldc, std::size_t m,
+                  std::size_t n) {
+    double acc[MR][NR] = {};
+    for (std::size_t p = 0; p < kc; ++p) {
+#pragma GCC unroll 4
+        for (std::size_t r = 0; r < MR; ++r) {
+            double ar = a[r];
+#pragma GCC unroll 8
+            for (std::size_t s = 0; s < NR; ++s)
+                acc[r][s] += ar * b[s];
+        }
+        a += MR;
+        b += NR;
+    }
+    for (std::size_t r = 0; r < m; ++r)
+        for (std::size_t s = 0; s < n; ++s)
+            c[r * ldc + s] += acc[r][s];
+}
+
+} // namespace
+
+const GemmBlocking &Matrix::gemm_blocking() noexcept { return blocking_; }
+
+void Matrix::set_gemm_blocking(const GemmBlocking &blocking) noexcept {
+    if (blocking.mc)
+        blocking_.mc = round_up(blocking.mc, MR);
+    if (blocking.kc)
+        blocking_.kc = blocking.kc;
+    if (blocking.nc)
+        blocking_.nc = round_up(blocking.nc, NR);
+}
+
+Matrix Matrix::operator*(const Matrix &B) const { return multiply(B, blocking_); }
+
+// Goto-style loop nest: for each nc-wide panel of B and kc-deep slice of K, pack B once;
+// for each mc-tall block of A pack A once, then sweep MR x NR tiles of C with the microkernel.
+Matrix Matrix::multiply(const Matrix &B, const GemmBlocking &blocking) const {
+    if (this->ncols() != B.nrows()) {
+        throw std::invalid_argument("Incompatible matrix dimensions for multiplication");
+    }
+    std::size_t R = this->nrows();
+    std::size_t K = this->ncols();
+    std::size_t Cc = B.ncols();
+    std::size_t mc = round_up(std::max<std::size_t>(blocking.mc, 1), MR);
+    std::size_t kc = std::max<std::size_t>(blocking.kc, 1);
+    std::size_t nc = round_up(std::max<std::size_t>(blocking.nc, 1), NR);
+
+    Matrix C(R, Cc);
+    if (R == 0 || K == 0 || Cc == 0)
+        return C;
+    std::vector<double> packed_a(std::min(mc, round_up(R, MR)) * std::min(kc, K));
+    std::vector<double> packed_b(std::min(kc, K) * std::min(nc, round_up(Cc, NR)));
+    const double *a = this->data();
+    const double *b = B.data();
+    double *c = C.data();
+
+    for (std::size_t jc = 0; jc < Cc; jc += nc) {
+        std::size_t nb = std::min(nc, Cc - jc);
+        for (std::size_t pc = 0; pc < K; pc += kc) {
+            std::size_t kb = std::min(kc, K - pc);
+            pack_b(b + pc * Cc + jc, Cc, kb, nb, packed_b.data());
+            for (std::size_t ic = 0; ic < R; ic += mc) {
+                std::size_t mb = std::min(mc, R - ic);
+                pack_a(a + ic * K + pc, K, mb, kb, packed_a.data());
+                for (std::size_t jr = 0; jr < nb; jr += NR) {
+                    const double *bp = packed_b.data() + jr * kb;
+                    for (std::size_t ir = 0; ir < mb; ir += MR) {
+                        micro_kernel(kb, packed_a.data() + ir * kb, bp, c + (ic + ir) * Cc + jc + jr, Cc,
+                                     std::min(MR, mb - ir), std::min(NR, nb - jr));
+                    }
+                }
+            }
+        }
+    }
+
+    return C;
+}
+
+Matrix Matrix::multiply_naive(const Matrix &B) const {
     if (this->ncols() != B.nrows()) {
         throw std::invalid_argument("Incompatible matrix dimensions for multiplication");
     }
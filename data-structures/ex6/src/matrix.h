@@ -4,6 +4,14 @@
 #include <cstddef>
 #include <vector>
 
+// Block sizes of the packed GEMM behind Matrix::operator*. A kc x 8 sliver of B
+// should stay in L1, the packed mc x kc block of A in L2 and the kc x nc panel of B in L3.
+struct GemmBlocking {
+    std::size_t mc = 128;
+    std::size_t kc = 256;
+    std::size_t nc = 4096;
+};
+
 class Matrix {
 public:
     Matrix(std::size_t rows, std::size_t cols);
@@ -22,7 +30,15 @@ public:
     double *operator[](std::size_t i) noexcept;
     const double *operator[](std::size_t i) const noexcept;
 
+    // Packed, cache-blocked product using gemm_blocking()
     Matrix operator*(const Matrix &other) const;
+    Matrix multiply(const Matrix &other, const GemmBlocking &blocking) const;
+    // Reference i-k-j triple loop
+    Matrix multiply_naive(const Matrix &other) const;
+
+    static const GemmBlocking &gemm_blocking() noexcept;
+    // Zero fields keep their current value
+    static void set_gemm_blocking(const GemmBlocking &blocking) noexcept;
 
     std::size_t nrows() const noexcept;
     std::size_t ncols() const noexcept;